@@ -0,0 +1,505 @@
+/**
+ * # Allocator benchmark
+ * Replays allocation trace against Allocator::Simple, Allocator::Slab and system malloc and reports
+ * throughput, p99 latency of single operation and fragmentation (RSS growth / live bytes).
+ *
+ * Trace is either synthetic or loaded from file. Trace file is a text, one operation per line:
+ *   a <id> <size>  - allocate object of <size> bytes and name it <id>
+ *   f <id>         - release object named <id>
+ * Objects not released by the end of the trace are considered live.
+ *
+ * In multi-threaded mode every thread replays own copy of the trace, but each release is passed to the next
+ * thread, so all objects are freed by thread other than one allocated it.
+ *
+ * Each backend runs in a separate process so that RSS of one doesn't affect the others.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/Slab.h>
+
+using namespace Afina;
+
+namespace {
+
+/**
+ * Single trace operation
+ */
+struct Op {
+    enum Type : uint8_t { Alloc, Free };
+
+    Type type;
+    uint32_t id;
+    uint32_t size;
+};
+
+/**
+ * Synthetic trace which follows size distribution typical for cache items: mostly small keys/values,
+ * rare large ones. Lifetime of each object is exponentially distributed
+ */
+std::vector<Op> SyntheticTrace(size_t ops, size_t mean_lifetime, uint32_t seed) {
+    std::mt19937 rnd(seed);
+    std::discrete_distribution<int> bucket({60, 25, 12, 3});
+    std::uniform_int_distribution<uint32_t> sizes[] = {
+        std::uniform_int_distribution<uint32_t>(16, 128), std::uniform_int_distribution<uint32_t>(129, 1024),
+        std::uniform_int_distribution<uint32_t>(1025, 8192), std::uniform_int_distribution<uint32_t>(8193, 32768)};
+    std::exponential_distribution<double> lifetime(1.0 / mean_lifetime);
+
+    // Pending releases ordered by time
+    typedef std::pair<size_t, uint32_t> death;
+    std::priority_queue<death, std::vector<death>, std::greater<death>> alive;
+
+    std::vector<Op> trace;
+    trace.reserve(ops);
+
+    uint32_t next_id = 0;
+    for (size_t now = 0; trace.size() < ops; now++) {
+        if (!alive.empty() && alive.top().first <= now) {
+            trace.push_back({Op::Free, alive.top().second, 0});
+            alive.pop();
+        } else {
+            uint32_t size = sizes[bucket(rnd)](rnd);
+            trace.push_back({Op::Alloc, next_id, size});
+            alive.push(death(now + 1 + static_cast<size_t>(lifetime(rnd)), next_id));
+            next_id++;
+        }
+    }
+    return trace;
+}
+
+/**
+ * Trace recorded in file, ids are remapped to dense numbers
+ */
+std::vector<Op> RecordedTrace(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open trace " + path);
+    }
+
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<Op> trace;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string type, name;
+        uint32_t size = 0;
+        if (!(fields >> type >> name) || type.empty() || type[0] == '#') {
+            continue;
+        }
+
+        if (type == "a" && (fields >> size)) {
+            uint32_t id = static_cast<uint32_t>(ids.size());
+            ids[name] = id;
+            trace.push_back({Op::Alloc, id, size});
+        } else if (type == "f" && ids.count(name) > 0) {
+            trace.push_back({Op::Free, ids[name], 0});
+        } else {
+            throw std::runtime_error("Malformed trace line: " + line);
+        }
+    }
+    return trace;
+}
+
+/**
+ * System allocator
+ */
+struct MallocBackend {
+    typedef void *handle;
+
+    static const char *name() { return "malloc"; }
+
+    bool probe() { return true; }
+
+    handle alloc(size_t N) { return std::malloc(N); }
+    void *get(handle h) { return h; }
+    void free(handle &h) { std::free(h); }
+};
+
+/**
+ * Arena wrapped by afina allocators. Pages aren't touched until used, so RSS reflects real consumption
+ */
+class Arena {
+public:
+    Arena(size_t size) : _size(size) {
+        _base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (_base == MAP_FAILED) {
+            throw std::runtime_error("Failed to map arena");
+        }
+    }
+    ~Arena() { munmap(_base, _size); }
+
+    void *base() const { return _base; }
+    size_t size() const { return _size; }
+
+private:
+    void *_base;
+    size_t _size;
+};
+
+/**
+ * Allocator::Slab, threadsafe by itself
+ */
+struct SlabBackend {
+    typedef void *handle;
+
+    SlabBackend(size_t arena_size) : arena(arena_size), slab(arena.base(), arena.size()) {}
+
+    static const char *name() { return "slab"; }
+
+    bool probe() { return true; }
+
+    handle alloc(size_t N) { return slab.alloc(N); }
+    void *get(handle h) { return h; }
+    void free(handle &h) { slab.free(h); }
+
+    Arena arena;
+    Allocator::Slab slab;
+};
+
+/**
+ * Allocator::Simple, isn't threadsafe so all calls are serialized
+ */
+struct SimpleBackend {
+    typedef Allocator::Pointer handle;
+
+    SimpleBackend(size_t arena_size) : arena(arena_size), simple(arena.base(), arena.size()) {}
+
+    static const char *name() { return "simple"; }
+
+    // Allocator could be just a stub returning nothing
+    bool probe() {
+        handle h = alloc(16);
+        bool result = (get(h) != nullptr);
+        free(h);
+        return result;
+    }
+
+    handle alloc(size_t N) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return simple.alloc(N);
+    }
+    void *get(handle &h) { return h.get(); }
+    void free(handle &h) {
+        std::lock_guard<std::mutex> lock(mutex);
+        simple.free(h);
+    }
+
+    Arena arena;
+    Allocator::Simple simple;
+    std::mutex mutex;
+};
+
+/**
+ * Process resident set size in bytes
+ */
+size_t ResidentBytes() {
+    long pages = 0, resident = 0;
+    FILE *f = std::fopen("/proc/self/statm", "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    std::fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Releases passed from other threads
+ */
+template <typename Handle> struct Inbox {
+    std::mutex mutex;
+    std::vector<Handle> items;
+};
+
+/**
+ * State of the thread replaying trace
+ */
+template <typename Backend> struct Replayer {
+    typedef typename Backend::handle handle;
+
+    std::vector<handle> objects;
+    std::vector<uint32_t> sizes;
+
+    // Latency of each operation, preallocated so that it doesn't affect RSS
+    std::vector<uint32_t> latency;
+    size_t ops;
+
+    // Bytes allocated by this thread and not released yet
+    std::atomic<int64_t> live_bytes;
+
+    Replayer() : ops(0), live_bytes(0) {}
+
+    void Prepare(const std::vector<Op> &trace) {
+        uint32_t max_id = 0;
+        for (const Op &op : trace) {
+            max_id = std::max(max_id, op.id);
+        }
+        objects.resize(max_id + 1);
+        sizes.resize(max_id + 1);
+
+        // Thread might release all objects of the neighbour as well as own ones
+        latency.assign(2 * trace.size(), 0);
+    }
+
+    void Record(std::chrono::steady_clock::time_point start) {
+        auto end = std::chrono::steady_clock::now();
+        latency[ops++] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    void Touch(Backend &backend, handle &h, size_t size) {
+        char *p = static_cast<char *>(backend.get(h));
+        for (size_t i = 0; i < size; i += 4096) {
+            p[i] = 1;
+        }
+        if (size > 0) {
+            p[size - 1] = 1;
+        }
+    }
+
+    // Release everything passed from the other threads
+    void Drain(Backend &backend, Inbox<handle> &inbox) {
+        std::vector<handle> items;
+        {
+            std::lock_guard<std::mutex> lock(inbox.mutex);
+            items.swap(inbox.items);
+        }
+
+        for (auto &item : items) {
+            auto start = std::chrono::steady_clock::now();
+            backend.free(item);
+            Record(start);
+        }
+    }
+
+    void Run(Backend &backend, const std::vector<Op> &trace, Inbox<handle> &inbox, Inbox<handle> *next) {
+        for (size_t i = 0; i < trace.size(); i++) {
+            const Op &op = trace[i];
+            if (op.type == Op::Alloc) {
+                auto start = std::chrono::steady_clock::now();
+                objects[op.id] = backend.alloc(op.size);
+                Record(start);
+
+                sizes[op.id] = op.size;
+                live_bytes += op.size;
+                Touch(backend, objects[op.id], op.size);
+            } else if (next == nullptr) {
+                auto start = std::chrono::steady_clock::now();
+                backend.free(objects[op.id]);
+                Record(start);
+
+                live_bytes -= sizes[op.id];
+            } else {
+                std::lock_guard<std::mutex> lock(next->mutex);
+                next->items.push_back(objects[op.id]);
+                live_bytes -= sizes[op.id];
+            }
+
+            if (next != nullptr && (i % 1024) == 0) {
+                Drain(backend, inbox);
+            }
+        }
+    }
+};
+
+/**
+ * Benchmark result
+ */
+struct Result {
+    double seconds;
+    size_t ops;
+    uint32_t p99;
+    int64_t live_bytes;
+    size_t rss_bytes;
+};
+
+template <typename Backend>
+Result Replay(Backend &backend, const std::vector<Op> &trace, size_t n_threads) {
+    typedef typename Backend::handle handle;
+    std::vector<Replayer<Backend> *> replayers;
+    std::vector<Inbox<handle>> inboxes(n_threads);
+    for (size_t i = 0; i < n_threads; i++) {
+        replayers.push_back(new Replayer<Backend>());
+        replayers.back()->Prepare(trace);
+        inboxes[i].items.reserve(trace.size());
+    }
+
+    size_t rss_before = ResidentBytes();
+
+    auto start = std::chrono::steady_clock::now();
+    if (n_threads == 1) {
+        replayers[0]->Run(backend, trace, inboxes[0], nullptr);
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < n_threads; i++) {
+            threads.emplace_back([&, i]() {
+                replayers[i]->Run(backend, trace, inboxes[i], &inboxes[(i + 1) % n_threads]);
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        // Threads could finish before their neighbours pass the last releases
+        for (size_t i = 0; i < n_threads; i++) {
+            replayers[i]->Drain(backend, inboxes[i]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    Result result;
+    result.seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    result.rss_bytes = ResidentBytes() - rss_before;
+    result.live_bytes = 0;
+    result.ops = 0;
+
+    std::vector<uint32_t> latency;
+    for (auto r : replayers) {
+        result.live_bytes += r->live_bytes;
+        result.ops += r->ops;
+        latency.insert(latency.end(), r->latency.begin(), r->latency.begin() + r->ops);
+    }
+
+    result.p99 = 0;
+    if (!latency.empty()) {
+        auto p99 = latency.begin() + (latency.size() * 99) / 100;
+        std::nth_element(latency.begin(), p99, latency.end());
+        result.p99 = *p99;
+    }
+
+    for (auto r : replayers) {
+        delete r;
+    }
+    return result;
+}
+
+template <typename Backend> void Report(Backend &backend, const std::vector<Op> &trace, size_t n_threads) {
+    if (!backend.probe()) {
+        std::cout << backend.name() << ": allocator doesn't return memory, skipped" << std::endl;
+        return;
+    }
+
+    try {
+        Result r = Replay(backend, trace, n_threads);
+
+        std::cout << backend.name() << ": threads=" << n_threads << " ops=" << r.ops
+                  << " ops/sec=" << static_cast<size_t>(r.ops / r.seconds) << " p99=" << r.p99 << "ns"
+                  << " live=" << r.live_bytes << " rss=" << r.rss_bytes;
+        if (r.live_bytes > 0) {
+            std::cout << " fragmentation=" << double(r.rss_bytes) / r.live_bytes;
+        }
+        std::cout << std::endl;
+    } catch (Allocator::AllocError &e) {
+        std::cout << backend.name() << ": out of memory, increase --arena" << std::endl;
+    }
+}
+
+/**
+ * Runs given function in a child process and waits for it
+ */
+template <typename F> void Isolated(F func) {
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid == -1) {
+        throw std::runtime_error("Failed to fork");
+    } else if (pid == 0) {
+        func();
+        std::cout.flush();
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cout << "benchmark process failed" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runAllocatorBenchmark", "Compare afina allocators with system malloc");
+    options.add_options()("b,backend", "Allocator to run: all, malloc, slab, simple",
+                          cxxopts::value<std::string>()->default_value("all"));
+    options.add_options()("t,threads", "Number of threads, freeing each other objects",
+                          cxxopts::value<size_t>()->default_value("1"));
+    options.add_options()("o,ops", "Number of operations in synthetic trace",
+                          cxxopts::value<size_t>()->default_value("1000000"));
+    options.add_options()("l,lifetime", "Mean lifetime of object in synthetic trace, in operations",
+                          cxxopts::value<size_t>()->default_value("10000"));
+    options.add_options()("s,seed", "Seed of synthetic trace", cxxopts::value<uint32_t>()->default_value("1"));
+    options.add_options()("trace", "Replay trace recorded in file instead of synthetic one",
+                          cxxopts::value<std::string>());
+    options.add_options()("arena", "Size of memory area for afina allocators, in MB",
+                          cxxopts::value<size_t>()->default_value("1024"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    std::vector<Op> trace;
+    if (options.count("trace") > 0) {
+        trace = RecordedTrace(options["trace"].as<std::string>());
+    } else {
+        trace = SyntheticTrace(options["ops"].as<size_t>(), options["lifetime"].as<size_t>(),
+                               options["seed"].as<uint32_t>());
+    }
+
+    const std::string backend = options["backend"].as<std::string>();
+    const size_t n_threads = std::max(size_t(1), options["threads"].as<size_t>());
+    const size_t arena_size = options["arena"].as<size_t>() * 1024 * 1024;
+
+    if (backend == "all" || backend == "malloc") {
+        Isolated([&]() {
+            MallocBackend b;
+            Report(b, trace, n_threads);
+        });
+    }
+    if (backend == "all" || backend == "slab") {
+        Isolated([&]() {
+            SlabBackend b(arena_size);
+            Report(b, trace, n_threads);
+        });
+    }
+    if (backend == "all" || backend == "simple") {
+        Isolated([&]() {
+            SimpleBackend b(arena_size);
+            Report(b, trace, n_threads);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * # Coroutine switch benchmark
+ * Two routines pass control to each other with sched, from the given depth of the stack, and report time a single
+ * switch takes in nanoseconds. Each level of depth is a frame of about 1KB, so the cost of copied stacks grows with it
+ * while switch of the dedicated ones stays the same.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+
+#include <cxxopts.hpp>
+
+#include <afina/coroutine/Engine.h>
+
+using namespace Afina;
+
+namespace {
+
+struct PingPong {
+    Coroutine::Engine *engine;
+    void *routines[2];
+    bool done[2];
+    size_t rounds;
+    size_t switches;
+};
+
+void Loop(PingPong &state, int id) {
+    for (size_t i = 0; i < state.rounds && !state.done[1 - id]; i++) {
+        state.switches++;
+        state.engine->sched(state.routines[1 - id]);
+    }
+    state.done[id] = true;
+}
+
+// Frames are kept alive across the call, so that compiler doesn't turn recursion into loop
+__attribute__((noinline)) void Descend(PingPong &state, int id, size_t depth) {
+    volatile char frame[1024];
+    frame[0] = char(depth);
+    if (depth > 0) {
+        Descend(state, id, depth - 1);
+    } else {
+        Loop(state, id);
+    }
+    frame[sizeof(frame) - 1] = frame[0];
+}
+
+void Player(PingPong &state, int id, size_t depth) { Descend(state, id, depth); }
+
+void Main(PingPong &state, size_t depth) {
+    for (int id = 0; id < 2; id++) {
+        state.routines[id] = state.engine->run(Player, state, int(id), size_t(depth));
+        if (state.routines[id] == nullptr) {
+            throw std::runtime_error("Failed to start routine");
+        }
+    }
+}
+
+/**
+ * Returns nanoseconds per switch
+ */
+double Measure(Coroutine::Engine::Stacks stacks, size_t rounds, size_t depth) {
+    Coroutine::Engine engine(nullptr, stacks);
+    PingPong state = {&engine, {nullptr, nullptr}, {false, false}, rounds, 0};
+
+    auto start = std::chrono::steady_clock::now();
+    engine.start(Main, state, size_t(depth));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / std::max(size_t(1), state.switches);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runCoroutineBenchmark", "Measure coroutine switch cost");
+    options.add_options()("n,rounds", "Number of times each routine passes control",
+                          cxxopts::value<size_t>()->default_value("1000000"));
+    options.add_options()("d,depth", "Depth of the stack switch happens at, in 1KB frames",
+                          cxxopts::value<size_t>()->default_value("0"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    const size_t rounds = std::max(size_t(1), options["rounds"].as<size_t>());
+    const size_t depth = options["depth"].as<size_t>();
+
+    std::cout << "rounds=" << rounds << " depth=" << depth << "KB" << std::endl;
+    std::cout << "copied=" << Measure(Coroutine::Engine::Stacks::Copied, rounds, depth) << "ns/switch" << std::endl;
+    try {
+        std::cout << "dedicated=" << Measure(Coroutine::Engine::Stacks::Dedicated, rounds, depth) << "ns/switch"
+                  << std::endl;
+    } catch (std::runtime_error &ex) {
+        std::cout << "dedicated=" << ex.what() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * # Network benchmark
+ * Closed loop load generator for the running server: every thread keeps given number of connections, sends a batch
+ * of pipelined memcached text commands over every one of them and then waits for all the responses before the next
+ * round. Reports requests per second along with the mean round trip of a batch, so that network implementations
+ * could be compared under the same client load.
+ *
+ * Commands are gets and sets over a fixed set of keys, values are made of single character so that responses are
+ * counted by their terminators only.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+namespace {
+
+struct Options {
+    std::string address;
+    uint16_t port;
+    size_t connections;
+    size_t depth;
+    size_t keys;
+    size_t value_size;
+    uint32_t set_ratio;
+};
+
+struct Result {
+    Result() : requests(0), rounds(0), round_time(0) {}
+
+    size_t requests;
+    size_t rounds;
+    double round_time;
+};
+
+int Connect(const Options &options) {
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.address.c_str(), &addr.sin_addr) != 1) {
+        throw std::runtime_error("Invalid server address");
+    }
+
+    int s = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+    if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(s);
+        throw std::runtime_error("Failed to connect: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &opts, sizeof(opts));
+    return s;
+}
+
+void SendAll(int s, const std::string &data) {
+    for (size_t pos = 0; pos < data.size();) {
+        ssize_t n = send(s, data.data() + pos, data.size() - pos, MSG_NOSIGNAL);
+        if (n <= 0) {
+            throw std::runtime_error("Failed to send: " + std::string(strerror(errno)));
+        }
+        pos += n;
+    }
+}
+
+// Reads until count responses are received, every one of them ends with either END or STORED line
+void ReceiveAll(int s, size_t count, std::string &buffer) {
+    static const char *const Ends[] = {"END\r\n", "STORED\r\n"};
+
+    buffer.clear();
+    size_t scanned = 0;
+    char chunk[65536];
+    while (count > 0) {
+        ssize_t n = recv(s, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            throw std::runtime_error("Connection closed by server");
+        }
+        buffer.append(chunk, n);
+
+        // Terminator could be split between reads, so scanning starts a bit before new data
+        for (;;) {
+            size_t found = std::string::npos, length = 0;
+            for (const char *end : Ends) {
+                size_t pos = buffer.find(end, scanned);
+                if (pos < found) {
+                    found = pos;
+                    length = std::strlen(end);
+                }
+            }
+            if (found == std::string::npos) {
+                break;
+            }
+            scanned = found + length;
+            count--;
+        }
+        if (buffer.size() > 8 && scanned < buffer.size() - 8) {
+            scanned = buffer.size() - 8;
+        }
+    }
+}
+
+void Run(const Options &options, uint32_t seed, const std::atomic<bool> &running, Result &result) {
+    std::mt19937 rnd(seed);
+    std::uniform_int_distribution<size_t> key(0, options.keys - 1);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    const std::string value(options.value_size, 'v');
+
+    std::vector<int> sockets;
+    for (size_t i = 0; i < options.connections; i++) {
+        sockets.push_back(Connect(options));
+    }
+
+    std::vector<std::string> batches(sockets.size());
+    std::string buffer;
+    while (running) {
+        for (size_t i = 0; i < sockets.size(); i++) {
+            std::string &batch = batches[i];
+            batch.clear();
+            for (size_t j = 0; j < options.depth; j++) {
+                std::string name = "key:" + std::to_string(key(rnd));
+                if (percent(rnd) < options.set_ratio) {
+                    batch += "set " + name + " 0 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+                } else {
+                    batch += "get " + name + "\r\n";
+                }
+            }
+        }
+
+        // All connections have batch in flight at once, then wait for them
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sockets.size(); i++) {
+            SendAll(sockets[i], batches[i]);
+        }
+        for (size_t i = 0; i < sockets.size(); i++) {
+            ReceiveAll(sockets[i], options.depth, buffer);
+        }
+        result.round_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.requests += sockets.size() * options.depth;
+        result.rounds++;
+    }
+
+    for (int s : sockets) {
+        close(s);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runNetworkBenchmark", "Load running afina server over memcached text protocol");
+    options.add_options()("a,address", "Server address", cxxopts::value<std::string>()->default_value("127.0.0.1"));
+    options.add_options()("p,port", "Server port", cxxopts::value<uint16_t>()->default_value("8080"));
+    options.add_options()("t,threads", "Number of client threads", cxxopts::value<size_t>()->default_value("4"));
+    options.add_options()("c,connections", "Number of connections of every thread",
+                          cxxopts::value<size_t>()->default_value("16"));
+    options.add_options()("d,depth", "Number of pipelined commands per connection",
+                          cxxopts::value<size_t>()->default_value("16"));
+    options.add_options()("k,keys", "Number of distinct keys", cxxopts::value<size_t>()->default_value("1000"));
+    options.add_options()("v,value", "Size of values set", cxxopts::value<size_t>()->default_value("32"));
+    options.add_options()("r,ratio", "Percent of sets among commands", cxxopts::value<uint32_t>()->default_value("10"));
+    options.add_options()("s,seconds", "Duration of the load", cxxopts::value<double>()->default_value("5"));
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    Options load;
+    load.address = options["address"].as<std::string>();
+    load.port = options["port"].as<uint16_t>();
+    load.connections = std::max(size_t(1), options["connections"].as<size_t>());
+    load.depth = std::max(size_t(1), options["depth"].as<size_t>());
+    load.keys = std::max(size_t(1), options["keys"].as<size_t>());
+    load.value_size = options["value"].as<size_t>();
+    load.set_ratio = std::min(uint32_t(100), options["ratio"].as<uint32_t>());
+    const size_t n_threads = std::max(size_t(1), options["threads"].as<size_t>());
+
+    std::atomic<bool> running(true), failed(false);
+    std::vector<Result> results(n_threads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < n_threads; i++) {
+        threads.emplace_back([&, i]() {
+            try {
+                Run(load, i + 1, running, results[i]);
+            } catch (std::runtime_error &ex) {
+                std::cerr << "Error: " << ex.what() << std::endl;
+                failed = true;
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(options["seconds"].as<double>()));
+    running = false;
+    for (auto &t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Result total;
+    for (const Result &r : results) {
+        total.requests += r.requests;
+        total.rounds += r.rounds;
+        total.round_time += r.round_time;
+    }
+
+    std::cout << "connections=" << n_threads * load.connections << " depth=" << load.depth
+              << " requests=" << total.requests << std::endl;
+    std::cout << "throughput=" << total.requests / seconds / 1e3 << "K requests/s round_trip="
+              << (total.rounds > 0 ? total.round_time / total.rounds * 1e3 : 0) << "ms" << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * # Parser benchmark
+ * Feeds pipelined memcached text protocol stream into Protocol::Parser chunk by chunk, the way connection does,
+ * and reports parse throughput in GB/s and commands per second. Data blocks are skipped as connection would pass
+ * them to the command, so only the parser itself is measured.
+ *
+ * Stream is either synthetic or loaded from file with raw bytes, for example captured from the wire. Synthetic
+ * stream is a mix of gets, multi-gets, sets and meta commands over keys with skewed popularity.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include <cxxopts.hpp>
+
+#include <afina/execute/AnyCommand.h>
+
+#include <protocol/Parser.h>
+
+using namespace Afina;
+
+namespace {
+
+/**
+ * Synthetic pipeline: 60% single key gets, 10% multi-gets of up to 16 keys, 20% sets, 10% meta get/set. Key
+ * popularity is skewed, value sizes are mostly small with rare large ones
+ */
+std::string SyntheticTrace(size_t commands, uint32_t seed) {
+    std::mt19937 rnd(seed);
+    std::discrete_distribution<int> kind({60, 10, 20, 5, 5});
+    std::geometric_distribution<uint32_t> key(0.001);
+    std::uniform_int_distribution<uint32_t> keys(2, 16);
+    std::discrete_distribution<int> bucket({70, 25, 5});
+    std::uniform_int_distribution<uint32_t> sizes[] = {std::uniform_int_distribution<uint32_t>(1, 100),
+                                                       std::uniform_int_distribution<uint32_t>(101, 1024),
+                                                       std::uniform_int_distribution<uint32_t>(1025, 16384)};
+
+    std::string trace;
+    for (size_t i = 0; i < commands; i++) {
+        switch (kind(rnd)) {
+        case 0:
+            trace += "get key:" + std::to_string(key(rnd)) + "\r\n";
+            break;
+        case 1: {
+            trace += "get";
+            for (uint32_t n = keys(rnd); n > 0; n--) {
+                trace += " key:" + std::to_string(key(rnd));
+            }
+            trace += "\r\n";
+            break;
+        }
+        case 2: {
+            uint32_t size = sizes[bucket(rnd)](rnd);
+            trace += "set key:" + std::to_string(key(rnd)) + " 0 0 " + std::to_string(size) + "\r\n";
+            trace.append(size, char('a' + i % 26));
+            trace += "\r\n";
+            break;
+        }
+        case 3:
+            trace += "mg key:" + std::to_string(key(rnd)) + " v s t\r\n";
+            break;
+        default: {
+            uint32_t size = sizes[bucket(rnd)](rnd);
+            trace += "ms key:" + std::to_string(key(rnd)) + " " + std::to_string(size) + " T0\r\n";
+            trace.append(size, char('a' + i % 26));
+            trace += "\r\n";
+            break;
+        }
+        }
+    }
+    return trace;
+}
+
+/**
+ * Parser state along with the data block it skips
+ */
+struct Stream {
+    Stream() : body_remains(0), commands(0), errors(0) {}
+
+    // Consumes next chunk of the stream
+    void Feed(const char *chunk, size_t size) {
+        size_t pos = 0;
+        while (pos < size) {
+            if (body_remains > 0) {
+                size_t skip = std::min(body_remains, size - pos);
+                body_remains -= skip;
+                pos += skip;
+                continue;
+            }
+
+            size_t parsed = 0;
+            if (parser.Parse(chunk + pos, size - pos, parsed)) {
+                size_t body_size = 0;
+                if (!parser.Build(command, body_size)) {
+                    errors++;
+                }
+                if (parser.WithBody()) {
+                    body_remains = body_size + 2;
+                }
+
+                commands++;
+                parser.Reset();
+            }
+            pos += parsed;
+        }
+    }
+
+    Protocol::Parser parser;
+    Execute::AnyCommand command;
+    size_t body_remains;
+    size_t commands;
+    size_t errors;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runParserBenchmark", "Measure memcached text protocol parser throughput");
+    options.add_options()("n,commands", "Number of commands in synthetic stream",
+                          cxxopts::value<size_t>()->default_value("200000"));
+    options.add_options()("c,chunk", "Stream is fed by chunks of this size, as read from socket",
+                          cxxopts::value<size_t>()->default_value("4096"));
+    options.add_options()("r,repeat", "Number of passes over the stream", cxxopts::value<size_t>()->default_value("10"));
+    options.add_options()("s,seed", "Seed of synthetic stream", cxxopts::value<uint32_t>()->default_value("1"));
+    options.add_options()("trace", "Parse raw bytes from file instead of synthetic stream",
+                          cxxopts::value<std::string>());
+    options.add_options()("h,help", "Print usage info");
+
+    try {
+        options.parse(argc, argv);
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (options.count("help") > 0) {
+        std::cerr << options.help() << std::endl;
+        return 0;
+    }
+
+    std::string trace;
+    if (options.count("trace") > 0) {
+        std::ifstream file(options["trace"].as<std::string>(), std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: can't open trace file" << std::endl;
+            return 1;
+        }
+        trace.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        trace = SyntheticTrace(options["commands"].as<size_t>(), options["seed"].as<uint32_t>());
+    }
+
+    const size_t chunk = std::max(size_t(1), options["chunk"].as<size_t>());
+    const size_t repeat = std::max(size_t(1), options["repeat"].as<size_t>());
+
+    Stream stream;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat; i++) {
+        for (size_t pos = 0; pos < trace.size(); pos += chunk) {
+            stream.Feed(trace.data() + pos, std::min(chunk, trace.size() - pos));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double bytes = double(trace.size()) * repeat;
+    std::cout << "stream=" << trace.size() << "B chunk=" << chunk << "B passes=" << repeat
+              << " commands=" << stream.commands << " errors=" << stream.errors << std::endl;
+    std::cout << "throughput=" << bytes / seconds / 1e9 << "GB/s " << stream.commands / seconds / 1e6
+              << "M commands/s" << std::endl;
+    return 0;
+}
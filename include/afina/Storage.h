@@ -1,8 +1,12 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <functional>
+#include <memory>
 #include <string>
 
+#include <afina/StringRef.h>
+
 namespace Afina {
 
 /**
@@ -25,10 +29,22 @@ public:
      * method returns true any subsequent access to storage must indicates that
      * key->value association exists
      *
+     * Key could point to the memory owned by caller, storage makes own copy of it
+     * if new association gets created
+     *
      * @param key to be associated with value
      * @param value to be assigned for the key
      */
-    virtual bool Put(const std::string &key, const std::string &value) = 0;
+    virtual bool Put(StringRef key, const std::string &value) = 0;
+
+    /**
+     * Same as Put, but storage is free to take the value buffer over instead of copying it, so that big values
+     * received from the network get stored without one more copy. Value is unspecified after the call
+     *
+     * @param key to be associated with value
+     * @param value to be moved into the storage
+     */
+    virtual bool Put(StringRef key, std::string &&value) { return Put(key, static_cast<const std::string &>(value)); }
 
     /**
      * Stores association between given key/value pair if key isn't present in
@@ -41,7 +57,7 @@ public:
      * @param key to be associated with value
      * @param value to be assigned for the key
      */
-    virtual bool PutIfAbsent(const std::string &key, const std::string &value) = 0;
+    virtual bool PutIfAbsent(StringRef key, const std::string &value) = 0;
 
     /**
      * Updates existing association between given key/value pair
@@ -54,7 +70,7 @@ public:
      * @param key to be associated with value
      * @param value to be assigned for the key
      */
-    virtual bool Set(const std::string &key, const std::string &value) = 0;
+    virtual bool Set(StringRef key, const std::string &value) = 0;
 
     /**
      * Removes association for the given key
@@ -70,7 +86,7 @@ public:
      *
      * @param key to be removed
      */
-    virtual bool Delete(const std::string &key) = 0;
+    virtual bool Delete(StringRef key) = 0;
 
     /**
      * Retrive key for the given value
@@ -83,7 +99,33 @@ public:
      * @param key to retrive1 value for
      * @param value output parameter to copy value to
      */
-    virtual bool Get(const std::string &key, std::string &value) = 0;
+    virtual bool Get(StringRef key, std::string &value) = 0;
+
+    /**
+     * Same as Get, but value is shared with the storage instead of being copied. Value is immutable, so caller
+     * could keep it as long as needed, even after the association is changed or deleted
+     *
+     * @param key to retrive value for
+     * @param value output parameter to put value to
+     */
+    virtual bool Get(StringRef key, std::shared_ptr<const std::string> &value) {
+        std::string copy;
+        if (!Get(key, copy)) {
+            return false;
+        }
+        value = std::make_shared<const std::string>(std::move(copy));
+        return true;
+    }
+
+    /**
+     * Runs group of operations as a single batch
+     * Storage passes into the function view on itself which must be used for all the operations of the batch.
+     * Implementation is free to take locks once for the whole batch instead of once per operation, so function
+     * must not touch the storage in any other way, nor block for a long time
+     *
+     * @param operations function performing operations against the given storage
+     */
+    virtual void Batch(const std::function<void(Storage &)> &operations) { operations(*this); }
 };
 
 } // namespace Afina
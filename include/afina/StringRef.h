@@ -0,0 +1,67 @@
+#ifndef AFINA_STRING_REF_H
+#define AFINA_STRING_REF_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace Afina {
+
+/**
+ * # Non-owning reference to a string
+ * Points to the bytes owned by someone else, for example to the key inside of the connection receive buffer,
+ * and allows to pass them around without a copy. Owner must keep bytes in place for the whole lifetime of
+ * the reference.
+ */
+class StringRef {
+public:
+    StringRef() : _data(nullptr), _size(0) {}
+    StringRef(const char *data, size_t size) : _data(data), _size(size) {}
+    StringRef(const char *str) : _data(str), _size(std::strlen(str)) {}
+    StringRef(const std::string &str) : _data(str.data()), _size(str.size()) {}
+
+    inline const char *data() const { return _data; }
+    inline size_t size() const { return _size; }
+    inline bool empty() const { return _size == 0; }
+
+    inline const char *begin() const { return _data; }
+    inline const char *end() const { return _data + _size; }
+
+    inline char operator[](size_t i) const { return _data[i]; }
+
+    /**
+     * Copy referenced bytes into a new string
+     */
+    inline std::string str() const { return std::string(_data, _size); }
+
+    /**
+     * Lexicographical comparison, same as std::string::compare
+     */
+    inline int compare(const StringRef &other) const {
+        size_t common = _size < other._size ? _size : other._size;
+        int result = (common == 0) ? 0 : std::memcmp(_data, other._data, common);
+        if (result != 0) {
+            return result;
+        }
+        return (_size < other._size) ? -1 : (_size > other._size ? 1 : 0);
+    }
+
+private:
+    const char *_data;
+    size_t _size;
+};
+
+inline bool operator==(const StringRef &a, const StringRef &b) {
+    return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool operator!=(const StringRef &a, const StringRef &b) { return !(a == b); }
+
+inline bool operator<(const StringRef &a, const StringRef &b) { return a.compare(b) < 0; }
+
+inline std::ostream &operator<<(std::ostream &out, const StringRef &s) { return out.write(s.data(), s.size()); }
+
+} // namespace Afina
+
+#endif // AFINA_STRING_REF_H
@@ -0,0 +1,112 @@
+#ifndef AFINA_ALLOCATOR_SLAB_H
+#define AFINA_ALLOCATOR_SLAB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Slab allocator
+ * Wraps given memory area, splits it into fixed size pages and serves each allocation from the page of the
+ * smallest size class able to hold it. Size classes grow by a constant factor, as in memcached.
+ *
+ * Objects never move, so unlike Simple allocator it returns raw pointers. Page index tells size class on free,
+ * so caller doesn't need to remember object size.
+ *
+ * Allocator is thread safe: each size class has own lock, so threads working with different sizes don't
+ * contend, and memory could be released from any thread.
+ *
+ * Allocator instance doesn't take ownership of wrapped memmory and do not delete it on destruction.
+ */
+class Slab {
+public:
+    /**
+     * @param base start of the memory area to serve allocations from
+     * @param size size of the memory area
+     * @param page_size size of the single slab, must be power of two. It is also the largest object size
+     * @param factor growth factor between adjacent size classes. Classes are at least 8 bytes apart, so
+     * there are at most page_size / 8 of them. Throws std::invalid_argument if page is so large that class
+     * index doesn't fit into 16 bits
+     */
+    Slab(void *base, const size_t size, const size_t page_size = 64 * 1024, const double factor = 1.25);
+    ~Slab();
+
+    /**
+     * Returns memory for object of N bytes. Throws AllocError(NoMemory) if there is no free page
+     * left for the size class or N is larger than page size
+     */
+    void *alloc(size_t N);
+
+    /**
+     * Returns object back to its size class. Throws AllocError(InvalidFree) if pointer doesn't belong
+     * to any allocated page
+     */
+    void free(void *p);
+
+    /**
+     * Number of bytes in the largest object allocator could serve
+     */
+    inline size_t max_size() const { return _page_size; }
+
+    /**
+     * Human readable state of size classes
+     */
+    std::string dump() const;
+
+private:
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    // Free object, reuses object memory itself
+    struct free_node {
+        free_node *next;
+    };
+
+    // Single size class
+    struct size_class {
+        size_t size = 0;
+
+        // Objects returned back to the class
+        free_node *free_list = nullptr;
+
+        // Not yet used part of the last page taken by the class
+        char *bump = nullptr;
+        char *bump_end = nullptr;
+
+        // Statistics
+        size_t pages = 0;
+        size_t used = 0;
+
+        std::mutex lock;
+    };
+
+    // Take new page from the wrapped area, nullptr if area is exhausted
+    char *take_page(uint16_t cls);
+
+    // Index of the smallest class which holds N bytes
+    size_t class_for(size_t N) const;
+
+    char *_base;
+    const size_t _base_len;
+    const size_t _page_size;
+
+    // Number of pages already given to size classes, guarded by _pages_lock
+    size_t _pages_taken;
+    std::mutex _pages_lock;
+
+    // Size class owning each page
+    std::vector<uint16_t> _page_class;
+
+    std::unique_ptr<size_class[]> _classes;
+    size_t _classes_count;
+};
+
+} // namespace Allocator
+} // namespace Afina
+#endif // AFINA_ALLOCATOR_SLAB_H
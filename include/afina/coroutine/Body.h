@@ -0,0 +1,39 @@
+#ifndef AFINA_COROUTINE_BODY_H
+#define AFINA_COROUTINE_BODY_H
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * Function along with arguments routine runs, kept aside for the routine having own stack
+ */
+struct Body {
+    virtual ~Body() {}
+    virtual void Run() = 0;
+};
+
+template <std::size_t... I> struct Indices {};
+template <std::size_t N, std::size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template <std::size_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+/**
+ * Body calling plain function. Arguments passed by reference stay references, the rest are moved here
+ */
+template <typename... Ta> struct Function : Body {
+    Function(void (*func)(Ta...), Ta &&... args) : func(func), args(std::forward<Ta>(args)...) {}
+
+    void Run() override { call(typename MakeIndices<sizeof...(Ta)>::type()); }
+    template <std::size_t... I> void call(Indices<I...>) { func(std::forward<Ta>(std::get<I>(args))...); }
+
+    void (*func)(Ta...);
+    std::tuple<Ta...> args;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_BODY_H
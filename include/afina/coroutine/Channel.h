@@ -0,0 +1,87 @@
+#ifndef AFINA_COROUTINE_CHANNEL_H
+#define AFINA_COROUTINE_CHANNEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+#include <afina/coroutine/Sync.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Bounded queue between routines
+ * Sender waits while channel is full, receiver waits while it is empty, both give control to other routines
+ * meanwhile. Values are received in the order they were sent. Once channel is closed nothing could be sent, values
+ * already in the channel could still be received. Capacity 0 is treated as 1.
+ *
+ * Not threadsafe, as the engine itself
+ */
+template <typename T> class Channel {
+public:
+    Channel(Engine &engine, size_t capacity)
+        : _capacity(std::max(size_t(1), capacity)), _closed(false), _senders(engine), _receivers(engine) {}
+
+    /**
+     * Puts value into the channel, waits for the room if it is full. Returns false if channel is closed
+     */
+    bool send(T value) {
+        while (!_closed && _buffer.size() >= _capacity) {
+            _senders.Wait();
+        }
+        if (_closed) {
+            return false;
+        }
+
+        _buffer.push_back(std::move(value));
+        _receivers.NotifyOne();
+        return true;
+    }
+
+    /**
+     * Takes the oldest value from the channel, waits for it if channel is empty. Returns false once channel is closed
+     * and there is nothing left
+     */
+    bool receive(T &value) {
+        while (!_closed && _buffer.empty()) {
+            _receivers.Wait();
+        }
+        if (_buffer.empty()) {
+            return false;
+        }
+
+        value = std::move(_buffer.front());
+        _buffer.pop_front();
+        _senders.NotifyOne();
+        return true;
+    }
+
+    /**
+     * Wakes up everyone waiting, senders fail and receivers take what is left
+     */
+    void close() {
+        _closed = true;
+        _senders.NotifyAll();
+        _receivers.NotifyAll();
+    }
+
+    size_t size() const { return _buffer.size(); }
+    size_t capacity() const { return _capacity; }
+    bool closed() const { return _closed; }
+
+private:
+    std::deque<T> _buffer;
+    size_t _capacity;
+    bool _closed;
+
+    // Routines waiting for room and for values
+    WaitQueue _senders;
+    WaitQueue _receivers;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CHANNEL_H
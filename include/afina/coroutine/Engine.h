@@ -1,11 +1,17 @@
 #ifndef AFINA_COROUTINE_ENGINE_H
 #define AFINA_COROUTINE_ENGINE_H
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <setjmp.h>
 #include <tuple>
+#include <vector>
+
+#include <afina/coroutine/Body.h>
 
 namespace Afina {
 namespace Coroutine {
@@ -13,8 +19,34 @@ namespace Coroutine {
 /**
  * # Entry point of coroutine library
  * Allows to run coroutine and schedule its execution. Not threadsafe
+ *
+ * Routine could block itself waiting for some event, for example socket to become readable. Blocked routine isn't
+ * scheduled until someone unblocks it. Once there is nothing ready to run engine calls unblocker, function waiting
+ * for the events routines are blocked on
  */
 class Engine final {
+public:
+    /**
+     * Called by the engine once all routines left are blocked, should wait until some of them could be unblocked
+     */
+    using unblocker_func = std::function<void(Engine &)>;
+
+    /**
+     * Where routines run
+     */
+    enum class Stacks {
+        // On the stack of the thread: stack of the suspended routine is copied aside and put back once it is resumed,
+        // so switch costs as much as the stack is deep
+        Copied,
+
+        // On the own stack of the routine, taken from the pool of the engine. There is guard page below the stack, so
+        // overflow crashes instead of corrupting memory. Switch just saves and restores registers, x86-64 only
+        Dedicated
+    };
+
+    // Size of the dedicated stack, guard page isn't included
+    static constexpr size_t DefaultStackSize = 128 * 1024;
+
 private:
     /**
      * A single coroutine instance which could be scheduled for execution
@@ -34,6 +66,16 @@ private:
         // Saved coroutine context (registers)
         jmp_buf Environment;
 
+        // Dedicated stack memory starting from the guard page and stack pointer saved once routine is switched out
+        char *Memory = nullptr;
+        void *SP = nullptr;
+
+        // What dedicated stack routine runs
+        std::unique_ptr<Body> Entry;
+
+        // Routine is in the "blocked" list and can't be scheduled
+        bool is_blocked = false;
+
         // To include routine in the different lists, such as "alive", "blocked", e.t.c
         struct context *prev = nullptr;
         struct context *next = nullptr;
@@ -54,11 +96,33 @@ private:
      */
     context *alive;
 
+    /**
+     * List of routines waiting to be unblocked
+     */
+    context *blocked;
+
     /**
      * Context to be returned finally
      */
     context *idle_ctx;
 
+    /**
+     * Waits for the events blocked routines need, could be empty
+     */
+    unblocker_func unblocker;
+
+    /**
+     * Where routines run, size of the dedicated stack and the ones free for the next routines
+     */
+    Stacks stacks;
+    size_t stack_size;
+    std::vector<char *> free_stacks;
+
+    /**
+     * Routine done on the dedicated stack, released once control is off its stack
+     */
+    context *finished;
+
 protected:
     /**
      * Save stack of the current coroutine in the given context
@@ -75,8 +139,44 @@ protected:
      */
     // void Enter(context& ctx);
 
+    /**
+     * Give dedicated stack to the routine, so that once switched to it starts from Enter. Returns false if there
+     * is no memory for the stack
+     */
+    bool Prepare(context &ctx);
+
+    /**
+     * Entry point of the routine having dedicated stack, runs its body and passes control to idle once it is done
+     */
+    static void Enter(Engine *engine, context *ctx);
+
+    /**
+     * Save registers of the routine running on the dedicated stack and switch to the other one
+     */
+    void Switch(context &from, context &to);
+
+    /**
+     * Schedules routines running on the dedicated stacks until all are done, runs on the stack of the thread
+     */
+    void Idle();
+
+    /**
+     * Frees stack of the routine, either copy or dedicated one
+     */
+    void Release(context &ctx);
+
+    /**
+     * Include routine into the head of the given list or exclude it from there
+     */
+    static void Link(context *&list, context *ctx);
+    static void Unlink(context *&list, context *ctx);
+
 public:
-    Engine() : StackBottom(0), cur_routine(nullptr), alive(nullptr) {}
+    /**
+     * Throws std::runtime_error if dedicated stacks aren't supported on the platform
+     */
+    Engine(unblocker_func unblocker = nullptr, Stacks stacks = Stacks::Copied, size_t stack_size = DefaultStackSize);
+    ~Engine();
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
 
@@ -99,12 +199,29 @@ public:
      */
     void sched(void *routine);
 
+    /**
+     * Blocks the given routine, so that it isn't scheduled until unblocked. If routine isn't specified the current one
+     * is blocked and control goes to any other ready to run, or to the unblocker if there is no such
+     */
+    void block(void *routine = nullptr);
+
+    /**
+     * Makes blocked routine ready to run again, it gets control once scheduled. Noop if routine isn't blocked
+     */
+    void unblock(void *routine);
+
+    /**
+     * Routine running now, nullptr outside of routines
+     */
+    void *current() const { return cur_routine; }
+
     /**
      * Entry point into the engine. Prepare all internal mechanics and starts given function which is
      * considered as main.
      *
      * Once control returns back to caller of start all coroutines are done execution, in other words,
-     * this function doesn't return control until all coroutines are done.
+     * this function doesn't return control until all coroutines are done. Routines left blocked once there is
+     * no unblocker to wait for them are dropped without being resumed.
      *
      * @param pointer to the main coroutine
      * @param arguments to be passed to the main coroutine
@@ -118,8 +235,14 @@ public:
         void *pc = run(main, std::forward<Ta>(args)...);
         idle_ctx = new context();
 
-        if (setjmp(idle_ctx->Environment) > 0) {
-            // Here: correct finish of the coroutine section
+        if (stacks == Stacks::Dedicated) {
+            // Routines come back to idle only once they are done or blocked
+            Idle();
+        } else if (setjmp(idle_ctx->Environment) > 0) {
+            // Here: correct finish of the coroutine section, or all routines left are blocked
+            while (alive == nullptr && blocked != nullptr && unblocker) {
+                unblocker(*this);
+            }
             yield();
         } else if (pc != nullptr) {
             Store(*idle_ctx);
@@ -127,7 +250,14 @@ public:
         }
 
         // Shutdown runtime
+        while (blocked != nullptr) {
+            context *ctx = blocked;
+            Unlink(blocked, ctx);
+            Release(*ctx);
+            delete ctx;
+        }
         delete idle_ctx;
+        idle_ctx = nullptr;
         this->StackBottom = 0;
     }
 
@@ -144,6 +274,17 @@ public:
         // New coroutine context that carries around all information enough to call function
         context *pc = new context();
 
+        // Routine having own stack starts from scratch, there is nothing to remember here
+        if (stacks == Stacks::Dedicated) {
+            pc->Entry.reset(new Function<Ta...>(func, std::forward<Ta>(args)...));
+            if (!Prepare(*pc)) {
+                delete pc;
+                return nullptr;
+            }
+            Link(alive, pc);
+            return pc;
+        }
+
         // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
         // execution starts here. Note that we have to acquire stack of the current function call to ensure
         // that function parameters will be passed along
@@ -158,22 +299,11 @@ public:
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
-
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
+            Unlink(alive, pc);
 
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            delete std::get<0>(pc->Stack);
+            Release(*pc);
             delete pc;
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
@@ -188,12 +318,7 @@ public:
         Store(*pc);
 
         // Add routine as alive double-linked list
-        pc->next = alive;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
-
+        Link(alive, pc);
         return pc;
     }
 };
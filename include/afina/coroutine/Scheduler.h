@@ -0,0 +1,141 @@
+#ifndef AFINA_COROUTINE_SCHEDULER_H
+#define AFINA_COROUTINE_SCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <afina/coroutine/Body.h>
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # M:N coroutine runtime
+ * Runs routines on the pool of threads, processors, one per core by default. Each processor has its own run queue
+ * and epoll. Routine started by another routine goes to the queue of the processor it was started on, processor
+ * runs routines from the head of its queue and, once there is nothing left, steals one from the tail of the queue
+ * of another processor.
+ *
+ * Routine waiting for file descriptor is registered in epoll of its owner, the processor it was started on or the
+ * last one that stole it, so polling spreads across processors along with routines. Once descriptor is ready owner
+ * puts routine back into own queue. Processor polls for events once it has nothing to run and every few routines
+ * otherwise.
+ *
+ * Routines run on dedicated stacks, so the runtime is x86-64 only. Routine could be moved to another thread at any
+ * wait or yield: it must not keep pointers to thread local variables across them. Note that errno is one of them,
+ * compiler could reuse its address got before the wait, so it is better checked in a function that doesn't wait.
+ *
+ * Scheduler itself is threadsafe
+ */
+class Scheduler final {
+public:
+    /**
+     * Throws std::runtime_error if the platform isn't supported or epoll can't be created
+     */
+    Scheduler(size_t threads = 0, size_t stack_size = Engine::DefaultStackSize);
+    ~Scheduler();
+    Scheduler(Scheduler &&) = delete;
+    Scheduler(const Scheduler &) = delete;
+
+    /**
+     * Spawns threads running the routines, number given to constructor or one per core if it is 0
+     */
+    void Start();
+
+    /**
+     * Blocks calling thread until all routines are done, including ones they start, then stops the threads. Routines
+     * waiting for descriptors that never get ready keep it waiting
+     */
+    void Join();
+
+    /**
+     * Register new routine. Called from a routine puts new one in the queue of the current processor, otherwise
+     * processors get new routines in turn. Returns false if there is no memory for the stack
+     */
+    template <typename... Ta> bool run(void (*func)(Ta...), Ta &&... args) {
+        return Spawn(new Function<Ta...>(func, std::forward<Ta>(args)...));
+    }
+
+    /**
+     * Gives up current routine execution, routine goes to the tail of the queue of the current processor
+     */
+    void yield();
+
+    /**
+     * Blocks current routine until file descriptor reports any of the given epoll events. Descriptor must not be
+     * waited for by another routine at the same time. Returns events got, EPOLLERR if descriptor can't be polled
+     */
+    uint32_t wait(int fd, uint32_t events);
+
+private:
+    struct Task;
+    struct Processor;
+
+    // What processor does with the routine once it is switched out
+    enum class Action { Yield, Wait, Done };
+
+    // Processor of the calling thread, nullptr outside of the scheduler threads. Never inlined, so that routine moved
+    // to another thread sees processor it runs on now
+    static Processor *Current();
+
+    // Takes ownership of the body, see run
+    bool Spawn(Body *body);
+
+    // Loop of the processor thread
+    void Loop(Processor &proc);
+
+    // Entry point of the routine, runs its body and passes control back to the processor
+    static void Enter(Scheduler *scheduler, Task *task);
+
+    // Runs routine until it yields, waits or is done and does what it asked for after that
+    void Run(Processor &proc, Task *task);
+
+    // Switches from the current routine to the processor, which performs given action then
+    void Park(Action action);
+
+    // Puts routines into the tail of the queue and wakes processor up to run or steal them if it sleeps
+    void Push(Processor &proc, Task **tasks, size_t count);
+
+    // Takes routine from the head of the own queue or steals it from the tail of another, nullptr if there is none
+    Task *Pop(Processor &proc);
+    Task *Steal(Processor &proc);
+
+    // Waits for the events up to the timeout, puts routines they are for into the queue
+    void Poll(Processor &proc, int timeout);
+
+    // Wakes sleeping processor, the given one or any if it is nullptr
+    void Wake(Processor *proc);
+
+    // Called once routine is done, finishes processors once all are done and Join waits for them
+    void Finished();
+
+    // Size of the routine stacks
+    size_t _stack_size;
+
+    // Processors, one per thread
+    std::vector<std::unique_ptr<Processor>> _processors;
+
+    // Processor to get routine started from the outside next
+    std::atomic<size_t> _next;
+
+    // Routines not done yet
+    std::atomic<size_t> _live;
+
+    // Join was called, processors exit once it is set and there are no routines left
+    std::mutex _mutex;
+    bool _joining;
+    std::atomic<bool> _done;
+
+    // Processor of the thread
+    static thread_local Processor *_current;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SCHEDULER_H
@@ -0,0 +1,124 @@
+#ifndef AFINA_COROUTINE_SYNC_H
+#define AFINA_COROUTINE_SYNC_H
+
+#include <cstddef>
+#include <list>
+
+namespace Afina {
+namespace Coroutine {
+
+// Forward declaration, see afina/coroutine/Engine.h
+class Engine;
+
+/**
+ * # Routines waiting for something
+ * Waiting routine is blocked in the engine, so it gives control to others until notified. Routines are notified in
+ * the order they started to wait. Routine unblocked by someone else, for example by socket event, keeps waiting.
+ *
+ * Like the engine, neither this nor primitives built on it are threadsafe. Routines the engine drops once it is done
+ * must not be notified after that
+ */
+class WaitQueue {
+public:
+    explicit WaitQueue(Engine &engine) : _engine(engine) {}
+    WaitQueue(const WaitQueue &) = delete;
+    WaitQueue &operator=(const WaitQueue &) = delete;
+
+    /**
+     * Blocks current routine until it is notified. Throws std::runtime_error if called outside of routine
+     */
+    void Wait();
+
+    /**
+     * Makes the routine waiting longest ready to run. Returns false if there is no one waiting
+     */
+    bool NotifyOne();
+
+    /**
+     * Makes every routine waiting ready to run
+     */
+    void NotifyAll();
+
+    /**
+     * Number of routines waiting
+     */
+    size_t Size() const { return _waiting.size(); }
+
+private:
+    struct Waiter {
+        void *routine;
+        bool notified;
+    };
+
+    Engine &_engine;
+
+    // Notified routine is moved into the second list, so it finds own entry there once resumed
+    std::list<Waiter> _waiting;
+    std::list<Waiter> _notified;
+};
+
+/**
+ * # Mutual exclusion of routines
+ * Routine waiting for the lock doesn't block the thread. Lock is handed over to waiters in the order they came, so
+ * nobody could take it in between. Meets Lockable, so works with std::lock_guard and std::unique_lock
+ */
+class Mutex {
+public:
+    explicit Mutex(Engine &engine) : _locked(false), _waiters(engine) {}
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+private:
+    bool _locked;
+    WaitQueue _waiters;
+};
+
+/**
+ * # Condition variable for routines
+ * Mutex is released while routine waits and locked again before wait returns
+ */
+class CondVar {
+public:
+    explicit CondVar(Engine &engine) : _waiters(engine) {}
+
+    void wait(Mutex &mutex);
+    template <typename Predicate> void wait(Mutex &mutex, Predicate condition) {
+        while (!condition()) {
+            wait(mutex);
+        }
+    }
+
+    void notify_one();
+    void notify_all();
+
+private:
+    WaitQueue _waiters;
+};
+
+/**
+ * # Waits for a group of routines to finish
+ * Counter is increased by add for every routine started and decreased by done once routine is finished, wait blocks
+ * until counter reaches zero
+ */
+class WaitGroup {
+public:
+    explicit WaitGroup(Engine &engine) : _count(0), _waiters(engine) {}
+
+    /**
+     * Throws std::runtime_error if counter gets negative
+     */
+    void add(int delta = 1);
+    void done() { add(-1); }
+    void wait();
+
+private:
+    long _count;
+    WaitQueue _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SYNC_H
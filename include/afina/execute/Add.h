@@ -20,10 +20,16 @@ namespace Execute {
  */
 class Add : public InsertCommand {
 public:
-    Add(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Add(StringRef key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Add() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Same as Execute, but without making response, for client asked for noreply. Returns true if value has
+     * been stored
+     */
+    bool Store(Storage &storage, const std::string &args);
 };
 
 } // namespace Execute
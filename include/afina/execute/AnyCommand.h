@@ -0,0 +1,141 @@
+#ifndef AFINA_EXECUTE_ANY_COMMAND_H
+#define AFINA_EXECUTE_ANY_COMMAND_H
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Add.h"
+#include "Append.h"
+#include "Get.h"
+#include "MetaDelete.h"
+#include "MetaGet.h"
+#include "MetaNoop.h"
+#include "MetaSet.h"
+#include "Output.h"
+#include "Replace.h"
+#include "Set.h"
+#include "Stats.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Place for one command of any type
+ * Keeps command built by the parser in place, without heap allocation, and runs it by switch over the type
+ * calling concrete Execute method directly instead of going through the vtable. Connection owns one instance
+ * and reuses it for every command it gets.
+ *
+ * Besides the command itself place keeps keys command references but which are not in the client input, so that
+ * command is independent from the parser once built. Buffers keep capacity between commands.
+ */
+class AnyCommand {
+public:
+    enum class Type : uint8_t { None, Set, Add, Replace, Append, Get, Stats, MetaGet, MetaSet, MetaDelete, MetaNoop };
+
+    AnyCommand() : _type(Type::None) {}
+    ~AnyCommand() { destroy(); }
+
+    AnyCommand(const AnyCommand &) = delete;
+    AnyCommand &operator=(const AnyCommand &) = delete;
+
+    /**
+     * Destroy current command, if any, and construct new one of type T in place
+     */
+    template <typename T, typename... Args> T &emplace(Args &&... args) {
+        destroy();
+        T *result = new (&_storage) T(std::forward<Args>(args)...);
+        _type = type_of<T>::value;
+        return *result;
+    }
+
+    /**
+     * Returns pointer to the command if it has type T, nullptr otherwise
+     */
+    template <typename T> T *get() {
+        return (_type == type_of<T>::value) ? reinterpret_cast<T *>(&_storage) : nullptr;
+    }
+
+    /**
+     * Destroy current command and forget keys it owns
+     */
+    void reset() {
+        destroy();
+        _keys.clear();
+        _scratch.clear();
+    }
+
+    /**
+     * Keys of the command and bytes of those keys which are owned by the command. Builder fills them before
+     * command gets constructed by emplace, which leaves them untouched
+     */
+    inline std::vector<StringRef> &keys() { return _keys; }
+    inline std::string &scratch() { return _scratch; }
+
+    inline Type type() const { return _type; }
+    explicit operator bool() const { return _type != Type::None; }
+
+    /**
+     * Run the command, see Command::Execute. Storing commands move args into the storage, so args content is
+     * unspecified after the call
+     */
+    void Execute(Storage &storage, std::string &args, std::string &out);
+
+    /**
+     * Run the command appending its response, terminated by \r\n, to the out. Nothing is appended if command
+     * has nothing to say
+     */
+    void Execute(Storage &storage, std::string &args, Output &out);
+
+    /**
+     * Run the command dropping its response, as client asked by noreply. Storing commands don't make the
+     * response at all
+     */
+    void Execute(Storage &storage, std::string &args);
+
+private:
+    template <typename T> struct type_of;
+
+    // Destroy current command
+    void destroy();
+
+    Type _type;
+    typename std::aligned_union<0, Set, Add, Replace, Append, Get, Stats, MetaGet, MetaSet, MetaDelete,
+                                MetaNoop>::type _storage;
+
+    std::vector<StringRef> _keys;
+    std::string _scratch;
+};
+
+template <> struct AnyCommand::type_of<Set> { static constexpr AnyCommand::Type value = AnyCommand::Type::Set; };
+template <> struct AnyCommand::type_of<Add> { static constexpr AnyCommand::Type value = AnyCommand::Type::Add; };
+template <> struct AnyCommand::type_of<Replace> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::Replace;
+};
+template <> struct AnyCommand::type_of<Append> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::Append;
+};
+template <> struct AnyCommand::type_of<Get> { static constexpr AnyCommand::Type value = AnyCommand::Type::Get; };
+template <> struct AnyCommand::type_of<Stats> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::Stats;
+};
+template <> struct AnyCommand::type_of<MetaGet> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::MetaGet;
+};
+template <> struct AnyCommand::type_of<MetaSet> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::MetaSet;
+};
+template <> struct AnyCommand::type_of<MetaDelete> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::MetaDelete;
+};
+template <> struct AnyCommand::type_of<MetaNoop> {
+    static constexpr AnyCommand::Type value = AnyCommand::Type::MetaNoop;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_ANY_COMMAND_H
@@ -21,10 +21,16 @@ namespace Execute {
  */
 class Append : public InsertCommand {
 public:
-    Append(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Append(StringRef key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Append() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Same as Execute, but without making response, for client asked for noreply. Returns true if value has
+     * been stored
+     */
+    bool Store(Storage &storage, const std::string &args);
 };
 
 } // namespace Execute
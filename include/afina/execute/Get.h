@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 
+#include <afina/StringRef.h>
+
 #include "Command.h"
+#include "Output.h"
 
 namespace Afina {
 namespace Execute {
@@ -31,18 +34,31 @@ namespace Execute {
  * hold items with such keys (because they were never stored, or stored
  * but deleted to make space for more items, or expired, or explicitly
  * deleted by a client).
+ *
+ * Keys are references to the memory owned by whoever built the command, for example parser, and must stay
+ * in place until command gets executed. So is the array of keys itself: command keeps pointer to its first
+ * element and number of keys, so array must neither be destroyed nor grow until then
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get(const StringRef *keys, size_t count) : _keys(keys), _count(count) {}
+    Get(const std::vector<StringRef> &keys) : Get(keys.data(), keys.size()) {}
     ~Get() {}
 
-    inline const std::vector<std::string> &keys() const { return _keys; }
+    inline const StringRef *keys() const { return _keys; }
+    inline size_t count() const { return _count; }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
+    /**
+     * Same as Execute, but response, including the final \r\n, is appended to the out with values shared with
+     * the storage rather than copied
+     */
+    void Execute(Storage &storage, Output &out);
+
 private:
-    std::vector<std::string> _keys;
+    const StringRef *_keys;
+    size_t _count;
 };
 
 } // namespace Execute
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 
+#include <afina/StringRef.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -11,19 +13,20 @@ namespace Execute {
 
 /**
  * # Basic class for all insert commands
- *
+ * Key is a reference to the memory owned by whoever built the command, for example parser, storage makes a copy
+ * of it once new association created
  */
 class InsertCommand : public Command {
 public:
-    InsertCommand(const std::string &key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
+    InsertCommand(StringRef key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
     ~InsertCommand() {}
 
-    inline const std::string &key() const { return _key; }
+    inline StringRef key() const { return _key; }
     inline const uint32_t flags() const { return _flags; }
     inline const int32_t expire() const { return _expire; }
 
 protected:
-    const std::string _key;
+    const StringRef _key;
     const uint32_t _flags;
     const int32_t _expire;
 };
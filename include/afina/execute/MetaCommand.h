@@ -0,0 +1,64 @@
+#ifndef AFINA_EXECUTE_META_COMMAND_H
+#define AFINA_EXECUTE_META_COMMAND_H
+
+#include <string>
+
+#include <afina/StringRef.h>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Flags of the meta command
+ * Meta commands have a single-letter flags, some of them followed by a token, after the key:
+ * - q: quiet mode, response is omitted on miss for mg and on success for ms and md
+ * - O<token>: opaque, returned back as is
+ * - k: return key
+ * - v: mg only, return value
+ * - t, c, f, s: mg only, return TTL, CAS, client flags and size of the value. Storage doesn't keep TTL, CAS
+ *   and client flags, so they are always returned as -1 (never expires), 0 and 0
+ * - M<mode>: ms only, S is set (default), E is add, R is replace, A is append and P is prepend
+ * - T<ttl>, F<flags>: ms only, accepted and ignored, same as exptime and flags of the set command
+ */
+struct MetaFlags {
+    MetaFlags() : value(false), quiet(false), mode('S') {}
+
+    // Letters of the flags to be returned in response, in order they were requested
+    std::string returned;
+
+    // Opaque token
+    std::string opaque;
+
+    bool value;
+    bool quiet;
+    char mode;
+};
+
+/**
+ * # Basic class for meta commands
+ * Key is a reference to the memory owned by whoever built the command, same as for InsertCommand
+ */
+class MetaCommand : public Command {
+public:
+    MetaCommand(StringRef key, const MetaFlags &flags) : _key(key), _flags(flags) {}
+    ~MetaCommand() {}
+
+    inline StringRef key() const { return _key; }
+    inline const MetaFlags &flags() const { return _flags; }
+
+protected:
+    /**
+     * Appends flags requested to be returned to the out, each preceded by space
+     */
+    void AppendFlags(std::string &out, const std::string *value) const;
+
+    const StringRef _key;
+    const MetaFlags _flags;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_COMMAND_H
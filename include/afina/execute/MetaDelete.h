@@ -0,0 +1,30 @@
+#ifndef AFINA_EXECUTE_META_DELETE_H
+#define AFINA_EXECUTE_META_DELETE_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Meta delete, md <key> <flags>*
+ * Removes association for the key.
+ *
+ * Command must write result to the output, which could be:
+ * - "HD <flags>*" to indicate success, nothing in quiet mode
+ * - "NF" to indicate that the item with this key was not found
+ */
+class MetaDelete : public MetaCommand {
+public:
+    MetaDelete(StringRef key, const MetaFlags &flags) : MetaCommand(key, flags) {}
+    ~MetaDelete() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_DELETE_H
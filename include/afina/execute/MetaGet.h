@@ -0,0 +1,31 @@
+#ifndef AFINA_EXECUTE_META_GET_H
+#define AFINA_EXECUTE_META_GET_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Meta get, mg <key> <flags>*
+ * Retrives value and/or metadata for the key, what exactly gets returned is controlled by flags.
+ *
+ * Command must write result to the output, which could be:
+ * - "VA <size> <flags>*\r\n<data>", if value was requested
+ * - "HD <flags>*" if item was found, but value wasn't requested
+ * - "EN" on miss, nothing in quiet mode
+ */
+class MetaGet : public MetaCommand {
+public:
+    MetaGet(StringRef key, const MetaFlags &flags) : MetaCommand(key, flags) {}
+    ~MetaGet() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_GET_H
@@ -0,0 +1,27 @@
+#ifndef AFINA_EXECUTE_META_NOOP_H
+#define AFINA_EXECUTE_META_NOOP_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Meta no-op, mn
+ * Does nothing but responds "MN". Responses come in order of requests, so client pipelining quiet commands
+ * sends mn last and knows that all of them are done once "MN" is received.
+ */
+class MetaNoop : public Command {
+public:
+    MetaNoop() {}
+    ~MetaNoop() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_NOOP_H
@@ -0,0 +1,39 @@
+#ifndef AFINA_EXECUTE_META_SET_H
+#define AFINA_EXECUTE_META_SET_H
+
+#include <string>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Meta set, ms <key> <datalen> <flags>*\r\n<data>
+ * Stores data block for the key, M flag tells how: set, add, replace, append or prepend.
+ *
+ * Command must write result to the output, which could be:
+ * - "HD <flags>*" to indicate success, nothing in quiet mode
+ * - "NS" to indicate the data was not stored because the condition for the mode wasn't met
+ */
+class MetaSet : public MetaCommand {
+public:
+    MetaSet(StringRef key, const MetaFlags &flags) : MetaCommand(key, flags) {}
+    ~MetaSet() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Same as Execute, but in set mode args buffer is moved into the storage instead of being copied
+     */
+    void Execute(Storage &storage, std::string &&args, std::string &out);
+
+private:
+    // Writes result of the command into the out
+    void respond(bool stored, std::string &out) const;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_SET_H
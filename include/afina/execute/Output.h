@@ -0,0 +1,122 @@
+#ifndef AFINA_EXECUTE_OUTPUT_H
+#define AFINA_EXECUTE_OUTPUT_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Bytes to be sent to the client
+ * Output is a queue of segments. Small pieces, such as response lines and headers, are copied into fixed size chunks
+ * taken from the pool, consecutive pieces share the segment. Big values are referenced: output shares ownership over
+ * the value, so it goes from the storage to the socket without being copied. Network layer sends segments by writev,
+ * see prepare and consume. Bytes never move once appended: sent part of the segment just advances its start and
+ * chunk goes back to the pool once everything in it is sent
+ */
+class Output {
+public:
+    // Values shorter than this are cheaper to copy than to send as a separate segment
+    static constexpr size_t MinReference = 512;
+
+    // Size of the chunk copied bytes are placed into
+    static constexpr size_t ChunkSize = 4096;
+
+    Output() : _first_chunk(0), _tail_used(0), _first_segment(0), _size(0) {}
+
+    /**
+     * Append copy of the given bytes
+     */
+    void append(const char *data, size_t size);
+    void append(const char *data) { append(data, std::strlen(data)); }
+    void append(const std::string &data) { append(data.data(), data.size()); }
+    void append(size_t count, char c);
+    void push_back(char c) { append(&c, 1); }
+
+    /**
+     * Append the value by reference, value is kept alive until output is sent. Short values are copied
+     */
+    void append(std::shared_ptr<const std::string> value);
+
+    inline bool empty() const { return _size == 0; }
+
+    /**
+     * Number of bytes not sent yet
+     */
+    inline size_t size() const { return _size; }
+
+    /**
+     * Drop everything, chunks go back to the pool so that idle connection doesn't hold any
+     */
+    void clear();
+
+    /**
+     * Fills up to max iovecs by segments not sent yet, in order. Iovecs stay valid while output is appended, until
+     * their bytes are consumed
+     *
+     * @return number of iovecs filled
+     */
+    size_t prepare(struct iovec *iov, size_t max) const;
+
+    /**
+     * Drop first bytes of the output, because they were sent
+     *
+     * @param size number of bytes sent, not more than size()
+     */
+    void consume(size_t size);
+
+    /**
+     * Returns copy of the bytes not sent yet
+     */
+    std::string str() const;
+
+private:
+    // Gives chunk back to the pool
+    struct ChunkDeleter {
+        void operator()(char *chunk) const;
+    };
+
+    // Chunk along with the number of its bytes used, the last one is being filled and its size is kept aside
+    struct Chunk {
+        std::unique_ptr<char[], ChunkDeleter> data;
+        size_t used;
+    };
+
+    // Segment references either value or, if there is no one, bytes of the chunk
+    struct Segment {
+        std::shared_ptr<const std::string> value;
+        const char *data;
+        size_t size;
+    };
+
+    // Returns room of the last chunk, takes new one if it is full
+    char *room(size_t &size);
+
+    // Account size bytes just copied into the last chunk
+    void copied(size_t size);
+
+    // Move entries not sent yet to the beginning once sent ones take most of the queue
+    template <typename T> static void compact(std::vector<T> &queue, size_t &first);
+
+    // Queues are vectors rather than deques, which allocate even when empty: drained output keeps just the capacity
+    // of a few entries. Entries before the first ones are sent already
+    std::vector<Chunk> _chunks;
+    size_t _first_chunk;
+    size_t _tail_used;
+    std::vector<Segment> _segments;
+    size_t _first_segment;
+
+    // Number of bytes not sent yet
+    size_t _size;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_OUTPUT_H
@@ -21,10 +21,16 @@ namespace Execute {
  */
 class Replace : public InsertCommand {
 public:
-    Replace(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Replace(StringRef key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Replace() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Same as Execute, but without making response, for client asked for noreply. Returns true if value has
+     * been stored
+     */
+    bool Store(Storage &storage, const std::string &args);
 };
 
 } // namespace Execute
@@ -21,10 +21,21 @@ namespace Execute {
  */
 class Set : public InsertCommand {
 public:
-    Set(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Set(StringRef key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
     ~Set() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Same as Execute, but args buffer is moved into the storage instead of being copied
+     */
+    void Execute(Storage &storage, std::string &&args, std::string &out);
+
+    /**
+     * Stores value moving args buffer into the storage without making response, for client asked for noreply.
+     * Returns true if value has been stored
+     */
+    bool Store(Storage &storage, std::string &&args);
 };
 
 } // namespace Execute
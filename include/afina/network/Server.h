@@ -1,9 +1,13 @@
 #ifndef AFINA_NETWORK_SERVER_H
 #define AFINA_NETWORK_SERVER_H
 
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
+#include <sys/socket.h>
+
 namespace Afina {
 class Storage;
 namespace Logging {
@@ -18,7 +22,7 @@ namespace Network {
 class Server {
 public:
     Server(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-        : pStorage(ps), pLogging(pl) {}
+        : pStorage(ps), pLogging(pl), listen_backlog(SOMAXCONN) {}
     virtual ~Server() {}
 
     /**
@@ -28,6 +32,26 @@ public:
      */
     virtual void Start(uint16_t port, uint32_t acceptors = 1, uint32_t workers = 1) = 0;
 
+    /**
+     * Makes server to listen on the given port for clients speaking Redis protocol (RESP), in addition to
+     * memcached clients on the port given to Start. Must be called before Start. By default network doesn't
+     * support it
+     */
+    virtual void ListenResp(uint16_t port) { throw std::runtime_error("Network doesn't support RESP clients"); }
+
+    /**
+     * Sets length of the queue of connections established but not accepted yet. Once queue is full kernel drops
+     * new connections, so it should survive all clients reconnecting at once. Must be called before Start
+     */
+    void SetBacklog(int backlog) { listen_backlog = backlog; }
+
+    /**
+     * Makes every worker listen on its own socket bound to the same port with SO_REUSEPORT and accept connections
+     * by itself, so kernel spreads connections across workers and there is no need in acceptors. Must be called
+     * before Start. By default network doesn't support it
+     */
+    virtual void ReusePort() { throw std::runtime_error("Network doesn't support SO_REUSEPORT"); }
+
     /**
      * Signal all worker threads that server is going to shutdown. After method returns
      * no more connections should be accept, existing connections should stop receive commands,
@@ -55,6 +79,11 @@ protected:
      * Logging service to be used in order to report application progress
      */
     std::shared_ptr<Afina::Logging::Service> pLogging;
+
+    /**
+     * Length of the listen queue
+     */
+    int listen_backlog;
 };
 
 } // namespace Network
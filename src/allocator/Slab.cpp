@@ -0,0 +1,148 @@
+#include <afina/allocator/Slab.h>
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Allocator {
+
+// See Slab.h
+Slab::Slab(void *base, const size_t size, const size_t page_size, const double factor)
+    : _base(static_cast<char *>(base)), _base_len(size), _page_size(page_size), _pages_taken(0),
+      _page_class(size / page_size, 0) {
+
+    // Size classes: 16, 20, 25, ... aligned to 8 bytes, the last one is a whole page
+    std::vector<size_t> sizes;
+    size_t cls_size = 16;
+    while (cls_size < _page_size / 2) {
+        sizes.push_back(cls_size);
+
+        size_t next = static_cast<size_t>(cls_size * factor);
+        next = (next + 7) & ~size_t(7);
+        cls_size = (next > cls_size) ? next : cls_size + 8;
+    }
+    sizes.push_back(_page_size);
+    if (sizes.size() > size_t(std::numeric_limits<uint16_t>::max()) + 1) {
+        throw std::invalid_argument("Too many size classes, page size is too large");
+    }
+
+    _classes_count = sizes.size();
+    _classes.reset(new size_class[_classes_count]);
+    for (size_t i = 0; i < _classes_count; i++) {
+        _classes[i].size = sizes[i];
+    }
+}
+
+// See Slab.h
+Slab::~Slab() {}
+
+// See Slab.h
+void *Slab::alloc(size_t N) {
+    if (N > _page_size) {
+        throw AllocError(AllocErrorType::NoMemory, "Object is larger than slab page");
+    }
+
+    size_t cls_idx = class_for(N);
+    size_class &cls = _classes[cls_idx];
+    std::lock_guard<std::mutex> lock(cls.lock);
+
+    // Fast path: reuse released object
+    if (cls.free_list != nullptr) {
+        free_node *result = cls.free_list;
+        cls.free_list = result->next;
+        cls.used++;
+        return result;
+    }
+
+    // Carve new object out of the current page
+    if (cls.bump == nullptr || cls.bump + cls.size > cls.bump_end) {
+        char *page = take_page(static_cast<uint16_t>(cls_idx));
+        if (page == nullptr) {
+            throw AllocError(AllocErrorType::NoMemory, "No free pages left");
+        }
+
+        cls.bump = page;
+        cls.bump_end = page + _page_size;
+        cls.pages++;
+    }
+
+    void *result = cls.bump;
+    cls.bump += cls.size;
+    cls.used++;
+    return result;
+}
+
+// See Slab.h
+void Slab::free(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+
+    char *obj = static_cast<char *>(p);
+    if (obj < _base || obj >= _base + _page_class.size() * _page_size) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to allocator");
+    }
+
+    size_t page = (obj - _base) / _page_size;
+    {
+        std::lock_guard<std::mutex> lock(_pages_lock);
+        if (page >= _pages_taken) {
+            throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to allocated page");
+        }
+    }
+
+    size_class &cls = _classes[_page_class[page]];
+    std::lock_guard<std::mutex> lock(cls.lock);
+
+    free_node *node = static_cast<free_node *>(p);
+    node->next = cls.free_list;
+    cls.free_list = node;
+    cls.used--;
+}
+
+// See Slab.h
+std::string Slab::dump() const {
+    std::stringstream out;
+    out << "pages " << _pages_taken << "/" << _page_class.size() << std::endl;
+    for (size_t i = 0; i < _classes_count; i++) {
+        size_class &cls = _classes[i];
+        std::lock_guard<std::mutex> lock(cls.lock);
+        if (cls.pages == 0) {
+            continue;
+        }
+        out << "class " << cls.size << ": pages=" << cls.pages << " used=" << cls.used << std::endl;
+    }
+    return out.str();
+}
+
+// See Slab.h
+char *Slab::take_page(uint16_t cls) {
+    std::lock_guard<std::mutex> lock(_pages_lock);
+    if (_pages_taken >= _page_class.size()) {
+        return nullptr;
+    }
+
+    size_t page = _pages_taken++;
+    _page_class[page] = cls;
+    return _base + page * _page_size;
+}
+
+// See Slab.h
+size_t Slab::class_for(size_t N) const {
+    size_t lo = 0, hi = _classes_count - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (_classes[mid].size < N) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -61,7 +61,7 @@ void Executor::perform() {
         }
 
         if ((tasks.empty() && state == State::kStopping)) {
-            break
+            break;
         }
         if (isTimeout) {
             if (num_threads > low_watermark) {
@@ -1,19 +1,249 @@
 #include <afina/coroutine/Engine.h>
 
+#include <alloca.h>
 #include <setjmp.h>
+#include <stdexcept>
 #include <stdio.h>
 #include <string.h>
 
+#include <unistd.h>
+
+#include "Stack.h"
+
 namespace Afina {
 namespace Coroutine {
 
-void Engine::Store(context &ctx) {}
+constexpr size_t Engine::DefaultStackSize;
+
+namespace {
+
+// Stacks kept by the engine for the next routines, the rest are unmapped
+constexpr size_t MaxFreeStacks = 256;
+
+// Puts stack copy in place and jumps into the routine. Frame of the function must be below the stack being restored,
+// so that nothing it needs is overwritten by the copy
+__attribute__((noinline, noreturn)) void Resume(char *low, const char *copy, size_t size, jmp_buf &environment) {
+    memcpy(low, copy, size);
+    longjmp(environment, 1);
+}
+
+} // namespace
+
+// See Engine.h
+Engine::Engine(unblocker_func unblocker, Stacks stacks, size_t stack_size)
+    : StackBottom(0), cur_routine(nullptr), alive(nullptr), blocked(nullptr), idle_ctx(nullptr),
+      unblocker(std::move(unblocker)), stacks(stacks), finished(nullptr) {
+#if !defined(__x86_64__)
+    if (stacks == Stacks::Dedicated) {
+        throw std::runtime_error("Dedicated coroutine stacks aren't supported on the platform");
+    }
+#endif
+
+    // Stack is made of whole pages, so that its top is aligned as ABI needs
+    size_t page = sysconf(_SC_PAGESIZE);
+    this->stack_size = (stack_size + page - 1) / page * page;
+}
+
+// See Engine.h
+Engine::~Engine() {
+    for (char *memory : free_stacks) {
+        UnmapStack(memory, stack_size);
+    }
+}
+
+// See Engine.h
+void Engine::Store(context &ctx) {
+    char StackEndsHere;
+    if (&StackEndsHere < StackBottom) {
+        ctx.Low = &StackEndsHere;
+        ctx.Hight = StackBottom;
+    } else {
+        ctx.Low = StackBottom;
+        ctx.Hight = &StackEndsHere;
+    }
+
+    // Buffer is reused unless stack got deeper than it was before
+    uint32_t size = ctx.Hight - ctx.Low;
+    if (std::get<1>(ctx.Stack) < size) {
+        delete[] std::get<0>(ctx.Stack);
+        ctx.Stack = std::make_tuple(new char[size], size);
+    }
+    memcpy(std::get<0>(ctx.Stack), ctx.Low, size);
+}
+
+// See Engine.h
+void Engine::Restore(context &ctx) {
+    // Stack grows down: current frame is moved below the stack of the routine before it is copied back
+    char StackEndsHere;
+    if (&StackEndsHere >= ctx.Low) {
+        volatile char *padding = static_cast<char *>(alloca(&StackEndsHere - ctx.Low + 1));
+        padding[0] = 0;
+    }
+    Resume(ctx.Low, std::get<0>(ctx.Stack), ctx.Hight - ctx.Low, ctx.Environment);
+}
+
+// See Engine.h
+void Engine::yield() {
+    // Routines take turns: the one following the current in the alive list goes next
+    context *next = alive;
+    if (cur_routine != nullptr && !cur_routine->is_blocked) {
+        next = cur_routine->next != nullptr ? cur_routine->next : alive;
+        if (next == cur_routine) {
+            next = nullptr;
+        }
+    }
+
+    if (next != nullptr) {
+        sched(next);
+    } else if (cur_routine != nullptr && cur_routine->is_blocked) {
+        // Nothing else could run, engine waits for the routine to be unblocked
+        sched(idle_ctx);
+    }
+}
+
+// See Engine.h
+void Engine::sched(void *routine_) {
+    context *routine = static_cast<context *>(routine_);
+    if (routine == nullptr) {
+        return yield();
+    }
+    if (routine == cur_routine || routine->is_blocked) {
+        return;
+    }
+
+    context *from = cur_routine;
+    cur_routine = routine != idle_ctx ? routine : nullptr;
+    if (stacks == Stacks::Dedicated) {
+        // Nothing is copied, idle saves its registers as any routine does
+        return Switch(from != nullptr ? *from : *idle_ctx, *routine);
+    }
+
+    if (from != nullptr) {
+        if (setjmp(from->Environment) > 0) {
+            // Routine got control back
+            return;
+        }
+        Store(*from);
+    }
+    Restore(*routine);
+}
+
+// See Engine.h
+bool Engine::Prepare(context &ctx) {
+    char *memory = nullptr;
+    if (!free_stacks.empty()) {
+        memory = free_stacks.back();
+        free_stacks.pop_back();
+    } else if ((memory = MapStack(stack_size)) == nullptr) {
+        return false;
+    }
+
+    ctx.Memory = memory;
+    ctx.SP = Frame(memory, stack_size, reinterpret_cast<void (*)()>(&Engine::Enter), this, &ctx);
+    return ctx.SP != nullptr;
+}
+
+// See Engine.h
+void Engine::Enter(Engine *engine, context *ctx) {
+    ctx->Entry->Run();
+
+    // Stack the routine is still on can't be released here, so idle takes care of it
+    Unlink(engine->alive, ctx);
+    engine->cur_routine = nullptr;
+    engine->finished = ctx;
+    engine->Switch(*ctx, *engine->idle_ctx);
+}
+
+// See Engine.h
+void Engine::Switch(context &from, context &to) { Coroutine::Switch(&from.SP, to.SP); }
+
+// See Engine.h
+void Engine::Idle() {
+    while (true) {
+        while (alive == nullptr && blocked != nullptr && unblocker) {
+            unblocker(*this);
+        }
+        if (alive == nullptr) {
+            return;
+        }
+
+        // Control is back once routine is done or everything left is blocked
+        sched(alive);
+        if (finished != nullptr) {
+            Release(*finished);
+            delete finished;
+            finished = nullptr;
+        }
+    }
+}
+
+// See Engine.h
+void Engine::Release(context &ctx) {
+    delete[] std::get<0>(ctx.Stack);
+    std::get<0>(ctx.Stack) = nullptr;
+    if (ctx.Memory == nullptr) {
+        return;
+    }
+
+    if (free_stacks.size() < MaxFreeStacks) {
+        free_stacks.push_back(ctx.Memory);
+    } else {
+        UnmapStack(ctx.Memory, stack_size);
+    }
+    ctx.Memory = nullptr;
+}
+
+// See Engine.h
+void Engine::block(void *routine_) {
+    context *routine = routine_ != nullptr ? static_cast<context *>(routine_) : cur_routine;
+    if (routine == nullptr || routine->is_blocked) {
+        return;
+    }
+
+    Unlink(alive, routine);
+    Link(blocked, routine);
+    routine->is_blocked = true;
+
+    if (routine == cur_routine) {
+        yield();
+    }
+}
+
+// See Engine.h
+void Engine::unblock(void *routine_) {
+    context *routine = static_cast<context *>(routine_);
+    if (routine == nullptr || !routine->is_blocked) {
+        return;
+    }
 
-void Engine::Restore(context &ctx) {}
+    Unlink(blocked, routine);
+    Link(alive, routine);
+    routine->is_blocked = false;
+}
 
-void Engine::yield() {}
+// See Engine.h
+void Engine::Link(context *&list, context *ctx) {
+    ctx->prev = nullptr;
+    ctx->next = list;
+    if (list != nullptr) {
+        list->prev = ctx;
+    }
+    list = ctx;
+}
 
-void Engine::sched(void *routine_) {}
+// See Engine.h
+void Engine::Unlink(context *&list, context *ctx) {
+    if (ctx->prev != nullptr) {
+        ctx->prev->next = ctx->next;
+    }
+    if (ctx->next != nullptr) {
+        ctx->next->prev = ctx->prev;
+    }
+    if (list == ctx) {
+        list = ctx->next;
+    }
+    ctx->prev = ctx->next = nullptr;
+}
 
 } // namespace Coroutine
 } // namespace Afina
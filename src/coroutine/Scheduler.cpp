@@ -0,0 +1,415 @@
+#include <afina/coroutine/Scheduler.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "Stack.h"
+
+namespace Afina {
+namespace Coroutine {
+
+namespace {
+
+// Stacks kept by the processor for the next routines, the rest are unmapped
+constexpr size_t MaxFreeStacks = 256;
+
+// Busy processor polls for events once per this number of routines run
+constexpr unsigned PollInterval = 64;
+
+// Number of events taken by a single poll
+constexpr int PollBatch = 64;
+
+} // namespace
+
+/**
+ * Routine along with its stack
+ */
+struct Scheduler::Task {
+    std::unique_ptr<Body> entry;
+
+    // Stack memory starting from the guard page and stack pointer saved once routine is switched out
+    char *memory = nullptr;
+    void *SP = nullptr;
+
+    // Processor routine waits for descriptors on, the one it was started on or the last one stole it
+    Processor *owner = nullptr;
+
+    // Events the last wait got
+    uint32_t events = 0;
+};
+
+/**
+ * Thread running routines
+ */
+struct Scheduler::Processor {
+    Scheduler *scheduler = nullptr;
+    size_t index = 0;
+    std::thread thread;
+
+    // Routines ready to run, processor takes them from the head and thieves from the tail
+    std::mutex mutex;
+    std::deque<Task *> queue;
+
+    // Descriptors routines owned by the processor wait for, and eventfd to wake the processor up
+    int epoll = -1;
+    int event_fd = -1;
+
+    // Processor waits for events having nothing to run
+    std::atomic<bool> sleeping{false};
+
+    // Stack pointer of the processor loop saved while routine runs, and the routine
+    void *SP = nullptr;
+    Task *current = nullptr;
+
+    // What routine asked for once switched out
+    Action action = Action::Done;
+    int wait_fd = -1;
+    uint32_t wait_events = 0;
+
+    std::vector<char *> free_stacks;
+    unsigned ticks = 0;
+
+    ~Processor() {
+        if (epoll != -1) {
+            close(epoll);
+        }
+        if (event_fd != -1) {
+            close(event_fd);
+        }
+    }
+};
+
+thread_local Scheduler::Processor *Scheduler::_current = nullptr;
+
+// See Scheduler.h
+__attribute__((noinline)) Scheduler::Processor *Scheduler::Current() { return _current; }
+
+// See Scheduler.h
+Scheduler::Scheduler(size_t threads, size_t stack_size) : _next(0), _live(0), _joining(false), _done(false) {
+#if !defined(__x86_64__)
+    throw std::runtime_error("Coroutine scheduler isn't supported on the platform");
+#endif
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    _stack_size = (stack_size + page - 1) / page * page;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        _processors.emplace_back(new Processor());
+        Processor &proc = *_processors.back();
+        proc.scheduler = this;
+        proc.index = i;
+
+        proc.epoll = epoll_create1(EPOLL_CLOEXEC);
+        proc.event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (proc.epoll == -1 || proc.event_fd == -1) {
+            throw std::runtime_error("Failed to create processor: " + std::string(strerror(errno)));
+        }
+
+        // Events without routine wake processor up
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_ctl(proc.epoll, EPOLL_CTL_ADD, proc.event_fd, &event)) {
+            throw std::runtime_error("Failed to add eventfd to epoll: " + std::string(strerror(errno)));
+        }
+    }
+}
+
+// See Scheduler.h
+Scheduler::~Scheduler() {
+    Join();
+
+    // Routines never run if scheduler wasn't started
+    for (auto &proc : _processors) {
+        for (Task *task : proc->queue) {
+            UnmapStack(task->memory, _stack_size);
+            delete task;
+        }
+        for (char *memory : proc->free_stacks) {
+            UnmapStack(memory, _stack_size);
+        }
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Start() {
+    for (auto &proc : _processors) {
+        if (!proc->thread.joinable()) {
+            proc->thread = std::thread(&Scheduler::Loop, this, std::ref(*proc));
+        }
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Join() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _joining = true;
+        if (_live == 0) {
+            _done = true;
+        }
+    }
+
+    if (_done) {
+        for (auto &proc : _processors) {
+            Wake(proc.get());
+        }
+    }
+    for (auto &proc : _processors) {
+        if (proc->thread.joinable()) {
+            proc->thread.join();
+        }
+    }
+}
+
+// See Scheduler.h
+void Scheduler::yield() {
+    Processor *proc = Current();
+    if (proc != nullptr && proc->current != nullptr) {
+        Park(Action::Yield);
+    }
+}
+
+// See Scheduler.h
+uint32_t Scheduler::wait(int fd, uint32_t events) {
+    Processor *proc = Current();
+    if (proc == nullptr || proc->current == nullptr) {
+        return EPOLLERR;
+    }
+
+    // Processor is left behind once routine is switched out, routine could be resumed by another one
+    Task *task = proc->current;
+    proc->wait_fd = fd;
+    proc->wait_events = events;
+    Park(Action::Wait);
+    return task->events;
+}
+
+// See Scheduler.h
+bool Scheduler::Spawn(Body *body) {
+    std::unique_ptr<Task> task(new Task());
+    task->entry.reset(body);
+
+    // Free stacks belong to the thread of the processor, others map new one
+    Processor *proc = Current();
+    if (proc != nullptr && proc->scheduler == this && !proc->free_stacks.empty()) {
+        task->memory = proc->free_stacks.back();
+        proc->free_stacks.pop_back();
+    } else if ((task->memory = MapStack(_stack_size)) == nullptr) {
+        return false;
+    }
+    if (proc == nullptr || proc->scheduler != this) {
+        proc = _processors[_next++ % _processors.size()].get();
+    }
+
+    task->owner = proc;
+    task->SP = Frame(task->memory, _stack_size, reinterpret_cast<void (*)()>(&Scheduler::Enter), this, task.get());
+    _live++;
+
+    Task *ready = task.release();
+    Push(*proc, &ready, 1);
+    return true;
+}
+
+// See Scheduler.h
+void Scheduler::Loop(Processor &proc) {
+    _current = &proc;
+    while (!_done) {
+        if (++proc.ticks % PollInterval == 0) {
+            Poll(proc, 0);
+        }
+
+        Task *task = Pop(proc);
+        if (task == nullptr) {
+            task = Steal(proc);
+        }
+        if (task == nullptr) {
+            // Sleep is announced before the last look at the queues, so routine pushed after it wakes processor up
+            proc.sleeping = true;
+            task = Pop(proc);
+            if (task == nullptr) {
+                task = Steal(proc);
+            }
+            if (task == nullptr && !_done) {
+                Poll(proc, -1);
+            }
+            proc.sleeping = false;
+        }
+
+        if (task != nullptr) {
+            Run(proc, task);
+        }
+    }
+    _current = nullptr;
+}
+
+// See Scheduler.h
+void Scheduler::Enter(Scheduler *scheduler, Task *task) {
+    task->entry->Run();
+    task->entry.reset();
+
+    // Stack the routine is still on can't be released here, so processor takes care of it
+    scheduler->Park(Action::Done);
+}
+
+// See Scheduler.h
+void Scheduler::Run(Processor &proc, Task *task) {
+    proc.current = task;
+    Switch(&proc.SP, task->SP);
+    proc.current = nullptr;
+
+    // Routine is off the processor now, so nothing else could resume it before it is done here
+    switch (proc.action) {
+    case Action::Yield:
+        Push(proc, &task, 1);
+        break;
+
+    case Action::Wait: {
+        struct epoll_event event;
+        event.events = proc.wait_events | EPOLLONESHOT;
+        event.data.ptr = task;
+        int epoll = task->owner->epoll;
+        if (epoll_ctl(epoll, EPOLL_CTL_MOD, proc.wait_fd, &event) != 0 &&
+            (errno != ENOENT || epoll_ctl(epoll, EPOLL_CTL_ADD, proc.wait_fd, &event) != 0)) {
+            task->events = EPOLLERR;
+            Push(proc, &task, 1);
+        }
+        break;
+    }
+
+    case Action::Done:
+        if (proc.free_stacks.size() < MaxFreeStacks) {
+            proc.free_stacks.push_back(task->memory);
+        } else {
+            UnmapStack(task->memory, _stack_size);
+        }
+        delete task;
+        Finished();
+        break;
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Park(Action action) {
+    Processor *proc = Current();
+    proc->action = action;
+    Switch(&proc->current->SP, proc->SP);
+}
+
+// See Scheduler.h
+void Scheduler::Push(Processor &proc, Task **tasks, size_t count) {
+    size_t queued = 0;
+    {
+        std::unique_lock<std::mutex> lock(proc.mutex);
+        proc.queue.insert(proc.queue.end(), tasks, tasks + count);
+        queued = proc.queue.size();
+    }
+
+    // Processor runs its queue once it is awake, surplus routines could be stolen by sleeping one
+    if (&proc != Current()) {
+        Wake(&proc);
+    }
+    if (queued > 1) {
+        Wake(nullptr);
+    }
+}
+
+// See Scheduler.h
+Scheduler::Task *Scheduler::Pop(Processor &proc) {
+    std::unique_lock<std::mutex> lock(proc.mutex);
+    if (proc.queue.empty()) {
+        return nullptr;
+    }
+    Task *task = proc.queue.front();
+    proc.queue.pop_front();
+    return task;
+}
+
+// See Scheduler.h
+Scheduler::Task *Scheduler::Steal(Processor &proc) {
+    for (size_t i = 1; i < _processors.size(); i++) {
+        Processor &victim = *_processors[(proc.index + i) % _processors.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            // Routine is ready to run, so it isn't registered in epoll of the victim and could wait on ours
+            Task *task = victim.queue.back();
+            victim.queue.pop_back();
+            task->owner = &proc;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+// See Scheduler.h
+void Scheduler::Poll(Processor &proc, int timeout) {
+    struct epoll_event events[PollBatch];
+    int nevents = epoll_wait(proc.epoll, events, PollBatch, timeout);
+    if (nevents <= 0) {
+        return;
+    }
+
+    Task *ready[PollBatch];
+    size_t count = 0;
+    for (int i = 0; i < nevents; i++) {
+        if (events[i].data.ptr == nullptr) {
+            eventfd_t value;
+            eventfd_read(proc.event_fd, &value);
+            continue;
+        }
+
+        Task *task = static_cast<Task *>(events[i].data.ptr);
+        task->events = events[i].events;
+        ready[count++] = task;
+    }
+    if (count > 0) {
+        Push(proc, ready, count);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Wake(Processor *proc) {
+    if (proc == nullptr) {
+        for (auto &other : _processors) {
+            if (other->sleeping && other->sleeping.exchange(false)) {
+                eventfd_write(other->event_fd, 1);
+                return;
+            }
+        }
+    } else if (proc->sleeping.exchange(false)) {
+        eventfd_write(proc->event_fd, 1);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Finished() {
+    if (--_live > 0) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_joining || _live > 0) {
+            return;
+        }
+        _done = true;
+    }
+    for (auto &proc : _processors) {
+        Wake(proc.get());
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,108 @@
+#include "Stack.h"
+
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+// Switch pushes registers callee must preserve by SysV ABI, along with SSE and x87 control words, onto the stack of
+// the routine being switched out and saves its stack pointer. Then it does the reverse for the routine switched in
+// and returns to where that one called switch. Everything else is saved by the caller of switch as by any call.
+//
+// New routine "returns" into trampoline, which calls entry given in r13 with arguments given in rbx and r12
+extern "C" void afina_coroutine_switch(void **from_sp, void *to_sp);
+extern "C" void afina_coroutine_trampoline();
+
+asm(R"(
+    .pushsection .text
+    .globl afina_coroutine_switch
+    .hidden afina_coroutine_switch
+    .type afina_coroutine_switch, @function
+afina_coroutine_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size afina_coroutine_switch, .-afina_coroutine_switch
+
+    .globl afina_coroutine_trampoline
+    .hidden afina_coroutine_trampoline
+    .type afina_coroutine_trampoline, @function
+afina_coroutine_trampoline:
+    movq %rbx, %rdi
+    movq %r12, %rsi
+    callq *%r13
+    ud2
+    .size afina_coroutine_trampoline, .-afina_coroutine_trampoline
+    .popsection
+)");
+#endif
+
+namespace Afina {
+namespace Coroutine {
+
+// See Stack.h
+char *MapStack(size_t size) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    void *mapped = mmap(nullptr, page + size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    char *memory = static_cast<char *>(mapped);
+    if (mprotect(memory, page, PROT_NONE) != 0) {
+        munmap(memory, page + size);
+        return nullptr;
+    }
+    return memory;
+}
+
+// See Stack.h
+void UnmapStack(char *memory, size_t size) { munmap(memory, sysconf(_SC_PAGESIZE) + size); }
+
+// See Stack.h
+void *Frame(char *memory, size_t size, void (*entry)(), void *first, void *second) {
+#if defined(__x86_64__)
+    // Frame switch pops: control words, r15, r14, r13, r12, rbx, rbp and return address. Once popped, stack is
+    // aligned the way trampoline calls entry
+    uint64_t *frame = reinterpret_cast<uint64_t *>(memory + sysconf(_SC_PAGESIZE) + size) - 10;
+    frame[0] = 0x1F80 | (uint64_t(0x037F) << 32);
+    frame[1] = frame[2] = frame[6] = 0;
+    frame[3] = reinterpret_cast<uint64_t>(entry);
+    frame[4] = reinterpret_cast<uint64_t>(second);
+    frame[5] = reinterpret_cast<uint64_t>(first);
+    frame[7] = reinterpret_cast<uint64_t>(&afina_coroutine_trampoline);
+    return frame;
+#else
+    return nullptr;
+#endif
+}
+
+// See Stack.h
+void Switch(void **from, void *to) {
+#if defined(__x86_64__)
+    afina_coroutine_switch(from, to);
+#endif
+}
+
+} // namespace Coroutine
+} // namespace Afina
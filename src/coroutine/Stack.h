@@ -0,0 +1,36 @@
+#ifndef AFINA_COROUTINE_STACK_H
+#define AFINA_COROUTINE_STACK_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * Maps stack of the given size, multiple of page size, with guard page below it. Returns memory starting from the
+ * guard page or nullptr if there is no memory
+ */
+char *MapStack(size_t size);
+
+/**
+ * Unmaps stack got from MapStack
+ */
+void UnmapStack(char *memory, size_t size);
+
+/**
+ * Builds initial frame on the stack mapped by MapStack, so that once switched to the stack pointer returned
+ * entry(first, second) gets called on that stack. Entry must never return. Returns nullptr if platform has no
+ * register switch
+ */
+void *Frame(char *memory, size_t size, void (*entry)(), void *first, void *second);
+
+/**
+ * Saves registers of the caller on its stack, stores stack pointer in from and continues from where to was
+ * stored. Noop if platform has no register switch
+ */
+void Switch(void **from, void *to);
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_STACK_H
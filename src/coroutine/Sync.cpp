@@ -0,0 +1,104 @@
+#include <afina/coroutine/Sync.h>
+
+#include <stdexcept>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+// See Sync.h
+void WaitQueue::Wait() {
+    void *routine = _engine.current();
+    if (routine == nullptr) {
+        throw std::runtime_error("Only coroutine could wait");
+    }
+
+    // Iterator stays valid once entry is moved to the notified list
+    auto waiter = _waiting.insert(_waiting.end(), Waiter{routine, false});
+    while (!waiter->notified) {
+        _engine.block();
+    }
+    _notified.erase(waiter);
+}
+
+// See Sync.h
+bool WaitQueue::NotifyOne() {
+    if (_waiting.empty()) {
+        return false;
+    }
+
+    auto waiter = _waiting.begin();
+    waiter->notified = true;
+    _notified.splice(_notified.end(), _waiting, waiter);
+    _engine.unblock(waiter->routine);
+    return true;
+}
+
+// See Sync.h
+void WaitQueue::NotifyAll() {
+    while (NotifyOne()) {
+    }
+}
+
+// See Sync.h
+void Mutex::lock() {
+    if (!_locked) {
+        _locked = true;
+        return;
+    }
+
+    // Mutex is still locked once routine is notified, unlock hands it over
+    _waiters.Wait();
+}
+
+// See Sync.h
+bool Mutex::try_lock() {
+    if (_locked) {
+        return false;
+    }
+    _locked = true;
+    return true;
+}
+
+// See Sync.h
+void Mutex::unlock() {
+    if (!_waiters.NotifyOne()) {
+        _locked = false;
+    }
+}
+
+// See Sync.h
+void CondVar::wait(Mutex &mutex) {
+    // Nothing runs in between, so notification can't be missed
+    mutex.unlock();
+    _waiters.Wait();
+    mutex.lock();
+}
+
+// See Sync.h
+void CondVar::notify_one() { _waiters.NotifyOne(); }
+
+// See Sync.h
+void CondVar::notify_all() { _waiters.NotifyAll(); }
+
+// See Sync.h
+void WaitGroup::add(int delta) {
+    _count += delta;
+    if (_count < 0) {
+        throw std::runtime_error("Negative WaitGroup counter");
+    }
+    if (_count == 0) {
+        _waiters.NotifyAll();
+    }
+}
+
+// See Sync.h
+void WaitGroup::wait() {
+    if (_count > 0) {
+        _waiters.Wait();
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,124 @@
+#include <afina/execute/AnyCommand.h>
+
+namespace Afina {
+namespace Execute {
+
+// See AnyCommand.h
+void AnyCommand::destroy() {
+    switch (_type) {
+    case Type::Set:
+        reinterpret_cast<Set *>(&_storage)->Set::~Set();
+        break;
+    case Type::Add:
+        reinterpret_cast<Add *>(&_storage)->Add::~Add();
+        break;
+    case Type::Replace:
+        reinterpret_cast<Replace *>(&_storage)->Replace::~Replace();
+        break;
+    case Type::Append:
+        reinterpret_cast<Append *>(&_storage)->Append::~Append();
+        break;
+    case Type::Get:
+        reinterpret_cast<Get *>(&_storage)->Get::~Get();
+        break;
+    case Type::Stats:
+        reinterpret_cast<Stats *>(&_storage)->Stats::~Stats();
+        break;
+    case Type::MetaGet:
+        reinterpret_cast<MetaGet *>(&_storage)->MetaGet::~MetaGet();
+        break;
+    case Type::MetaSet:
+        reinterpret_cast<MetaSet *>(&_storage)->MetaSet::~MetaSet();
+        break;
+    case Type::MetaDelete:
+        reinterpret_cast<MetaDelete *>(&_storage)->MetaDelete::~MetaDelete();
+        break;
+    case Type::MetaNoop:
+        reinterpret_cast<MetaNoop *>(&_storage)->MetaNoop::~MetaNoop();
+        break;
+    case Type::None:
+        break;
+    }
+    _type = Type::None;
+}
+
+// See AnyCommand.h
+void AnyCommand::Execute(Storage &storage, std::string &args, std::string &out) {
+    // Qualified calls are bound statically, no vtable lookup
+    switch (_type) {
+    case Type::Set:
+        reinterpret_cast<Set *>(&_storage)->Set::Execute(storage, std::move(args), out);
+        break;
+    case Type::Add:
+        reinterpret_cast<Add *>(&_storage)->Add::Execute(storage, args, out);
+        break;
+    case Type::Replace:
+        reinterpret_cast<Replace *>(&_storage)->Replace::Execute(storage, args, out);
+        break;
+    case Type::Append:
+        reinterpret_cast<Append *>(&_storage)->Append::Execute(storage, args, out);
+        break;
+    case Type::Get:
+        reinterpret_cast<Get *>(&_storage)->Get::Execute(storage, args, out);
+        break;
+    case Type::Stats:
+        reinterpret_cast<Stats *>(&_storage)->Stats::Execute(storage, args, out);
+        break;
+    case Type::MetaGet:
+        reinterpret_cast<MetaGet *>(&_storage)->MetaGet::Execute(storage, args, out);
+        break;
+    case Type::MetaSet:
+        reinterpret_cast<MetaSet *>(&_storage)->MetaSet::Execute(storage, std::move(args), out);
+        break;
+    case Type::MetaDelete:
+        reinterpret_cast<MetaDelete *>(&_storage)->MetaDelete::Execute(storage, args, out);
+        break;
+    case Type::MetaNoop:
+        reinterpret_cast<MetaNoop *>(&_storage)->MetaNoop::Execute(storage, args, out);
+        break;
+    case Type::None:
+        break;
+    }
+}
+
+// See AnyCommand.h
+void AnyCommand::Execute(Storage &storage, std::string &args, Output &out) {
+    // Multi-get response is big, it is built right in the output referencing values
+    if (_type == Type::Get) {
+        return reinterpret_cast<Get *>(&_storage)->Get::Execute(storage, out);
+    }
+
+    std::string result;
+    Execute(storage, args, result);
+    if (!result.empty()) {
+        out.append(result);
+        out.append("\r\n", 2);
+    }
+}
+
+// See AnyCommand.h
+void AnyCommand::Execute(Storage &storage, std::string &args) {
+    switch (_type) {
+    case Type::Set:
+        reinterpret_cast<Set *>(&_storage)->Set::Store(storage, std::move(args));
+        break;
+    case Type::Add:
+        reinterpret_cast<Add *>(&_storage)->Add::Store(storage, args);
+        break;
+    case Type::Replace:
+        reinterpret_cast<Replace *>(&_storage)->Replace::Store(storage, args);
+        break;
+    case Type::Append:
+        reinterpret_cast<Append *>(&_storage)->Append::Store(storage, args);
+        break;
+    default: {
+        // Only storing commands take noreply, others just have their response dropped
+        std::string result;
+        Execute(storage, args, result);
+        break;
+    }
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,21 +1,22 @@
 #include <afina/Storage.h>
 #include <afina/execute/Append.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "append" means "add this data to an existing key after existing data".
 void Append::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Append(" << _key << ")" << args << std::endl;
+    out.assign(Store(storage, args) ? "STORED" : "NOT_STORED");
+}
+
+// See Append.h
+bool Append::Store(Storage &storage, const std::string &args) {
     std::string value;
     if (!storage.Get(_key, value)) {
-        out.assign("NOT_STORED");
-        return;
+        return false;
     }
     storage.Put(_key, value + args);
-    out.assign("STORED");
+    return true;
 }
 
 } // namespace Execute
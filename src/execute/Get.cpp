@@ -1,9 +1,8 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <memory>
+#include <utility>
 
 namespace Afina {
 namespace Execute {
@@ -22,22 +21,32 @@ to indicate the end of response.
 */
 
 void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
+    Output output;
+    Execute(storage, output);
 
-    std::stringstream outStream;
+    // networking layer should add the last \r\n
+    out = output.str();
+    out.resize(out.size() - 2);
+}
 
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+// See Get.h
+void Get::Execute(Storage &storage, Output &out) {
+    std::shared_ptr<const std::string> value;
+    for (size_t i = 0; i < _count; i++) {
+        const StringRef &key = _keys[i];
+        if (!storage.Get(key, value)) {
             continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+        }
+
+        out.append("VALUE ", 6);
+        out.append(key.data(), key.size());
+        out.append(" 0 ", 3);
+        out.append(std::to_string(value->size()));
+        out.append("\r\n", 2);
+        out.append(std::move(value));
+        out.append("\r\n", 2);
     }
-    outStream << "END"; // networking layer should add the last \r\n
-
-    out = outStream.str();
+    out.append("END\r\n", 5);
 }
 
 } // namespace Execute
@@ -0,0 +1,38 @@
+#include <afina/execute/MetaCommand.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaCommand.h
+void MetaCommand::AppendFlags(std::string &out, const std::string *value) const {
+    for (char flag : _flags.returned) {
+        switch (flag) {
+        case 't':
+            out.append(" t-1");
+            break;
+        case 'c':
+            out.append(" c0");
+            break;
+        case 'f':
+            out.append(" f0");
+            break;
+        case 'k':
+            out.append(" k");
+            out.append(_key.data(), _key.size());
+            break;
+        case 's':
+            if (value != nullptr) {
+                out.append(" s");
+                out.append(std::to_string(value->size()));
+            }
+            break;
+        case 'O':
+            out.append(" O");
+            out.append(_flags.opaque);
+            break;
+        }
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,20 @@
+#include <afina/Storage.h>
+#include <afina/execute/MetaDelete.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaDelete.h
+void MetaDelete::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (!storage.Delete(_key)) {
+        out.assign("NF");
+    } else if (_flags.quiet) {
+        out.clear();
+    } else {
+        out.assign("HD");
+        AppendFlags(out, nullptr);
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,32 @@
+#include <afina/Storage.h>
+#include <afina/execute/MetaGet.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaGet.h
+void MetaGet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::string value;
+    if (!storage.Get(_key, value)) {
+        if (_flags.quiet) {
+            out.clear();
+        } else {
+            out.assign("EN");
+        }
+        return;
+    }
+
+    if (_flags.value) {
+        out.assign("VA ");
+        out.append(std::to_string(value.size()));
+        AppendFlags(out, &value);
+        out.append("\r\n");
+        out.append(value); // networking layer should add the last \r\n
+    } else {
+        out.assign("HD");
+        AppendFlags(out, &value);
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,54 @@
+#include <afina/Storage.h>
+#include <afina/execute/MetaSet.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaSet.h
+void MetaSet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    bool stored = false;
+    switch (_flags.mode) {
+    case 'S':
+        stored = storage.Put(_key, args);
+        break;
+    case 'E':
+        stored = storage.PutIfAbsent(_key, args);
+        break;
+    case 'R':
+        stored = storage.Set(_key, args);
+        break;
+    case 'A':
+    case 'P': {
+        std::string value;
+        if (storage.Get(_key, value)) {
+            stored = storage.Put(_key, (_flags.mode == 'A') ? value + args : args + value);
+        }
+        break;
+    }
+    }
+
+    respond(stored, out);
+}
+
+// See MetaSet.h
+void MetaSet::Execute(Storage &storage, std::string &&args, std::string &out) {
+    if (_flags.mode != 'S') {
+        return Execute(storage, static_cast<const std::string &>(args), out);
+    }
+    respond(storage.Put(_key, std::move(args)), out);
+}
+
+// See MetaSet.h
+void MetaSet::respond(bool stored, std::string &out) const {
+    if (!stored) {
+        out.assign("NS");
+    } else if (_flags.quiet) {
+        out.clear();
+    } else {
+        out.assign("HD");
+        AppendFlags(out, nullptr);
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,206 @@
+#include <afina/execute/Output.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+constexpr size_t Output::MinReference;
+constexpr size_t Output::ChunkSize;
+
+namespace {
+
+/**
+ * Free chunks of the thread. Output is appended and sent by the thread serving connection, so chunks rarely move
+ * between threads. Pool doesn't keep more than MaxFree chunks, the rest goes back to the allocator
+ */
+class ChunkPool {
+public:
+    static constexpr size_t MaxFree = 256;
+
+    ~ChunkPool();
+
+    char *Get() {
+        if (_free.empty()) {
+            return new char[Output::ChunkSize];
+        }
+        char *chunk = _free.back();
+        _free.pop_back();
+        return chunk;
+    }
+
+    void Put(char *chunk) {
+        if (_free.size() < MaxFree) {
+            _free.push_back(chunk);
+        } else {
+            delete[] chunk;
+        }
+    }
+
+private:
+    std::vector<char *> _free;
+};
+
+thread_local ChunkPool pool;
+
+// Output destroyed on thread exit could outlive the pool, its chunks go straight to the allocator then
+thread_local bool pool_destroyed = false;
+
+ChunkPool::~ChunkPool() {
+    for (char *chunk : _free) {
+        delete[] chunk;
+    }
+    pool_destroyed = true;
+}
+
+} // namespace
+
+// See Output.h
+void Output::ChunkDeleter::operator()(char *chunk) const {
+    if (pool_destroyed) {
+        delete[] chunk;
+    } else {
+        pool.Put(chunk);
+    }
+}
+
+// See Output.h
+void Output::append(const char *data, size_t size) {
+    while (size > 0) {
+        size_t room_size = 0;
+        char *to = room(room_size);
+
+        size_t n = std::min(size, room_size);
+        std::memcpy(to, data, n);
+        copied(n);
+        data += n;
+        size -= n;
+    }
+}
+
+// See Output.h
+void Output::append(size_t count, char c) {
+    while (count > 0) {
+        size_t room_size = 0;
+        char *to = room(room_size);
+
+        size_t n = std::min(count, room_size);
+        std::memset(to, c, n);
+        copied(n);
+        count -= n;
+    }
+}
+
+// See Output.h
+void Output::append(std::shared_ptr<const std::string> value) {
+    if (value->size() < MinReference) {
+        return append(value->data(), value->size());
+    }
+
+    _size += value->size();
+    compact(_segments, _first_segment);
+    _segments.push_back({std::move(value), nullptr, 0});
+    _segments.back().data = _segments.back().value->data();
+    _segments.back().size = _segments.back().value->size();
+}
+
+// See Output.h
+void Output::clear() {
+    _segments.clear();
+    _first_segment = 0;
+    _chunks.clear();
+    _first_chunk = 0;
+    _tail_used = 0;
+    _size = 0;
+}
+
+// See Output.h
+size_t Output::prepare(struct iovec *iov, size_t max) const {
+    size_t count = 0;
+    for (auto it = _segments.begin() + _first_segment; it != _segments.end() && count < max; it++, count++) {
+        iov[count].iov_base = const_cast<char *>(it->data);
+        iov[count].iov_len = it->size;
+    }
+    return count;
+}
+
+// See Output.h
+void Output::consume(size_t size) {
+    _size -= size;
+    if (_size == 0) {
+        return clear();
+    }
+
+    while (size > 0) {
+        Segment &segment = _segments[_first_segment];
+        if (size < segment.size) {
+            // Partially sent segment goes first next time
+            segment.data += size;
+            segment.size -= size;
+            break;
+        }
+
+        // Full chunk is given back along with its last segment
+        size -= segment.size;
+        if (!segment.value && _chunks.size() - _first_chunk > 1) {
+            Chunk &chunk = _chunks[_first_chunk];
+            if (segment.data + segment.size == chunk.data.get() + chunk.used) {
+                chunk.data.reset();
+                _first_chunk++;
+            }
+        }
+        _first_segment++;
+    }
+}
+
+// See Output.h
+std::string Output::str() const {
+    std::string result;
+    result.reserve(_size);
+    for (size_t i = _first_segment; i < _segments.size(); i++) {
+        result.append(_segments[i].data, _segments[i].size);
+    }
+    return result;
+}
+
+// See Output.h
+char *Output::room(size_t &size) {
+    if (_chunks.empty() || _tail_used == ChunkSize) {
+        if (!_chunks.empty()) {
+            _chunks.back().used = _tail_used;
+        }
+        compact(_chunks, _first_chunk);
+        _chunks.push_back({std::unique_ptr<char[], ChunkDeleter>(pool.Get()), 0});
+        _tail_used = 0;
+    }
+
+    size = ChunkSize - _tail_used;
+    return _chunks.back().data.get() + _tail_used;
+}
+
+// See Output.h
+void Output::copied(size_t size) {
+    // Bytes following the last copied ones extend its segment
+    const char *data = _chunks.back().data.get() + _tail_used;
+    if (_first_segment == _segments.size() || _segments.back().value ||
+        _segments.back().data + _segments.back().size != data) {
+        compact(_segments, _first_segment);
+        _segments.push_back({nullptr, data, 0});
+    }
+    _segments.back().size += size;
+    _tail_used += size;
+    _size += size;
+}
+
+// See Output.h
+template <typename T> void Output::compact(std::vector<T> &queue, size_t &first) {
+    // Vector grows as usual unless sent entries free enough room to reuse
+    if (queue.size() == queue.capacity() && first * 2 >= queue.size() && first > 0) {
+        queue.erase(queue.begin(), queue.begin() + first);
+        first = 0;
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,17 +1,22 @@
 #include <afina/Storage.h>
 #include <afina/execute/Set.h>
 
-#include <iostream>
-
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
+    Execute(storage, std::string(args), out);
+}
+
+// See Set.h
+void Set::Execute(Storage &storage, std::string &&args, std::string &out) {
+    Store(storage, std::move(args));
     out = "STORED";
 }
 
+// See Set.h
+bool Set::Store(Storage &storage, std::string &&args) { return storage.Put(_key, std::move(args)); }
+
 } // namespace Execute
 } // namespace Afina
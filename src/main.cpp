@@ -16,9 +16,12 @@
 
 #include "logging/ServiceImpl.h"
 #include "network/mt_blocking/ServerImpl.h"
+#include "network/mt_coroutine/ServerImpl.h"
 #include "network/mt_nonblocking/ServerImpl.h"
 #include "network/st_blocking/ServerImpl.h"
+#include "network/st_coroutine/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
+#include "network/uring/ServerImpl.h"
 
 #include "storage/SimpleLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
@@ -72,9 +75,28 @@ public:
             server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
         } else if (network_type == "mt_nonblock") {
             server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "st_coroutine") {
+            server = std::make_shared<Afina::Network::STcoroutine::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_coroutine") {
+            server = std::make_shared<Afina::Network::MTcoroutine::ServerImpl>(storage, logService);
+        } else if (network_type == "uring") {
+            server = std::make_shared<Afina::Network::Uring::ServerImpl>(storage, logService);
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        // Step 3: Redis protocol clients, if asked
+        if (options.count("resp") > 0) {
+            resp_port = options["resp"].as<uint16_t>();
+        }
+
+        // Step 4: Listen sockets
+        if (options.count("backlog") > 0) {
+            server->SetBacklog(options["backlog"].as<int>());
+        }
+        if (options.count("reuseport") > 0) {
+            server->ReusePort();
+        }
     }
 
     // Start services in correct order
@@ -89,6 +111,10 @@ public:
         // TODO: configure network service
         const uint16_t port = 8080;
         log->warn("Start network on {}", port);
+        if (resp_port != 0) {
+            log->warn("Serve RESP clients on {}", resp_port);
+            server->ListenResp(resp_port);
+        }
         server->Start(port, 2, 2);
     }
 
@@ -109,6 +135,9 @@ private:
 
     std::shared_ptr<Afina::Storage> storage;
     std::shared_ptr<Afina::Network::Server> server;
+
+    // Port to serve Redis protocol clients on, 0 if they aren't served
+    uint16_t resp_port = 0;
 };
 
 // Signal set that to notify application about time to stop
@@ -129,6 +158,12 @@ int main(int argc, char **argv) {
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("r,resp", "Port to serve Redis protocol clients on, non-blocking networks only",
+                              cxxopts::value<uint16_t>());
+        options.add_options()("b,backlog", "Length of the queue of connections not accepted yet",
+                              cxxopts::value<int>());
+        options.add_options()("reuseport",
+                              "Every worker accepts on its own SO_REUSEPORT socket, mt_nonblock and mt_coroutine only");
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
@@ -0,0 +1,154 @@
+#include "Input.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace Afina {
+namespace Network {
+
+constexpr size_t Input::InitialSize;
+constexpr size_t Input::MinRoom;
+constexpr size_t Input::MaxSize;
+
+namespace {
+
+/**
+ * Free buffers of the initial size, shared by all connections of the thread. Only connections being read at the
+ * moment hold buffers, so the pool stays as small as the number of them. Pool doesn't keep more than MaxFree buffers,
+ * the rest goes back to the allocator
+ */
+class BufferPool {
+public:
+    static constexpr size_t MaxFree = 256;
+
+    ~BufferPool();
+
+    char *Get() {
+        if (_free.empty()) {
+            return new char[Input::InitialSize];
+        }
+        char *buffer = _free.back();
+        _free.pop_back();
+        return buffer;
+    }
+
+    void Put(char *buffer) {
+        if (_free.size() < MaxFree) {
+            _free.push_back(buffer);
+        } else {
+            delete[] buffer;
+        }
+    }
+
+private:
+    std::vector<char *> _free;
+};
+
+thread_local BufferPool pool;
+
+// Input destroyed on thread exit could outlive the pool, its buffer goes straight to the allocator then
+thread_local bool pool_destroyed = false;
+
+BufferPool::~BufferPool() {
+    for (char *buffer : _free) {
+        delete[] buffer;
+    }
+    pool_destroyed = true;
+}
+
+char *allocate(size_t capacity) { return capacity == Input::InitialSize ? pool.Get() : new char[capacity]; }
+
+void deallocate(char *buffer, size_t capacity) {
+    if (capacity == Input::InitialSize && !pool_destroyed) {
+        pool.Put(buffer);
+    } else {
+        delete[] buffer;
+    }
+}
+
+} // namespace
+
+// See Input.h
+Input::~Input() {
+    if (_buffer != nullptr) {
+        deallocate(_buffer, _capacity);
+    }
+}
+
+// See Input.h
+char *Input::room(size_t &size) {
+    if (_capacity - _end < MinRoom) {
+        // Usually there is just a part of the last command left to move
+        if (_begin > 0) {
+            std::memmove(_buffer, data(), this->size());
+            _end -= _begin;
+            _begin = 0;
+        }
+        if (_capacity - _end < MinRoom && _capacity < MaxSize) {
+            resize(_capacity == 0 ? InitialSize : std::min(MaxSize, _capacity * 2));
+        }
+    }
+
+    if (_end == _capacity) {
+        throw std::runtime_error("Request doesn't fit into the buffer");
+    }
+
+    size = _capacity - _end;
+    return _buffer + _end;
+}
+
+// See Input.h
+void Input::append(const char *data, size_t size) {
+    while (size > 0) {
+        size_t room_size = 0;
+        char *to = room(room_size);
+
+        size_t n = std::min(size, room_size);
+        std::memcpy(to, data, n);
+        filled(n);
+        data += n;
+        size -= n;
+    }
+}
+
+// See Input.h
+void Input::consume(size_t size) {
+    _begin += size;
+    if (_begin == _end) {
+        _begin = _end = 0;
+
+        // Memory of the big request isn't kept by the idle connection, next read takes the usual one
+        if (_capacity > InitialSize) {
+            release();
+        }
+    }
+}
+
+// See Input.h
+void Input::release() {
+    if (_buffer == nullptr || !empty()) {
+        return;
+    }
+
+    deallocate(_buffer, _capacity);
+    _buffer = nullptr;
+    _capacity = _begin = _end = 0;
+}
+
+// See Input.h
+void Input::resize(size_t capacity) {
+    char *buffer = allocate(capacity);
+    if (_buffer != nullptr) {
+        std::memcpy(buffer, data(), size());
+        deallocate(_buffer, _capacity);
+    }
+    _end -= _begin;
+    _begin = 0;
+    _buffer = buffer;
+    _capacity = capacity;
+}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,96 @@
+#ifndef AFINA_NETWORK_INPUT_H
+#define AFINA_NETWORK_INPUT_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Bytes received from the client
+ * Contiguous buffer session parses in place. Consumed bytes just advance the read position, whatever is left is
+ * moved to the beginning only once there is not enough room after it, so pipelined commands are never shifted one
+ * by one. Buffer is borrowed from the pool of the thread once something is going to be read, grows if a single request
+ * doesn't fit into it and is given back by release once drained, so idle connection holds no buffer at all
+ */
+class Input {
+public:
+    // Size of the buffer allocated once anything is read and the least room next read gets
+    static constexpr size_t InitialSize = 4096;
+    static constexpr size_t MinRoom = 512;
+
+    // Requests larger than this are rejected
+    static constexpr size_t MaxSize = 2 * 1024 * 1024;
+
+    Input() : _buffer(nullptr), _capacity(0), _begin(0), _end(0) {}
+    ~Input();
+
+    Input(const Input &) = delete;
+    Input &operator=(const Input &) = delete;
+
+    /**
+     * Bytes received but not consumed yet
+     */
+    inline const char *data() const { return _buffer + _begin; }
+    inline size_t size() const { return _end - _begin; }
+    inline bool empty() const { return _begin == _end; }
+
+    /**
+     * Returns free space to read into, compacting or growing the buffer if there is too little of it. Throws
+     * std::runtime_error if buffer is full and can't grow anymore
+     *
+     * @param size set to the number of bytes available
+     */
+    char *room(size_t &size);
+
+    /**
+     * Account bytes read into the room
+     */
+    inline void filled(size_t size) { _end += size; }
+
+    /**
+     * Give buffer back to the pool if there is nothing left in it. Called once socket has no more data to read
+     */
+    void release();
+
+    /**
+     * Drop everything along with the buffer
+     */
+    inline void clear() {
+        consume(size());
+        release();
+    }
+
+    /**
+     * Size of the buffer currently held, zero if there is none
+     */
+    inline size_t capacity() const { return _capacity; }
+
+    /**
+     * Append copy of the given bytes. Throws std::runtime_error if they don't fit
+     */
+    void append(const char *data, size_t size);
+
+    /**
+     * Drop first bytes of the input, because session has processed them
+     *
+     * @param size number of bytes consumed, not more than size()
+     */
+    void consume(size_t size);
+
+private:
+    // Replace buffer by the new one of the given capacity, buffers of the initial size come from the pool
+    void resize(size_t capacity);
+
+    char *_buffer;
+    size_t _capacity;
+
+    // Bytes not consumed yet are in [_begin, _end)
+    size_t _begin;
+    size_t _end;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_INPUT_H
@@ -0,0 +1,80 @@
+#ifndef AFINA_NETWORK_POOL_H
+#define AFINA_NETWORK_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Free list of connections
+ * Closed connections are kept for reuse instead of being deleted, so accepting the next client allocates neither the
+ * connection nor its buffers: Get resets one released earlier by the same arguments it would be constructed with.
+ * Pool keeps at most max_free connections, the rest are deleted.
+ *
+ * Connection could be taken on one thread and released on another, pool is guarded by the lock which is uncontended
+ * when the same thread does both
+ */
+template <typename T> class Pool {
+public:
+    static constexpr size_t DefaultMaxFree = 1024;
+
+    explicit Pool(size_t max_free = DefaultMaxFree) : _max_free(max_free) {}
+    ~Pool() {
+        for (T *p : _free) {
+            delete p;
+        }
+    }
+
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    /**
+     * Returns connection released earlier, reset by the given arguments, or the new one
+     */
+    template <typename... Args> T *Get(Args &&... args) {
+        T *p = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (!_free.empty()) {
+                p = _free.back();
+                _free.pop_back();
+            }
+        }
+
+        if (p == nullptr) {
+            return new T(std::forward<Args>(args)...);
+        }
+        p->Reset(std::forward<Args>(args)...);
+        return p;
+    }
+
+    /**
+     * Takes connection back, its socket must be closed already
+     */
+    void Put(T *p) {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_free.size() < _max_free) {
+                _free.push_back(p);
+                return;
+            }
+        }
+        delete p;
+    }
+
+private:
+    std::mutex _lock;
+    size_t _max_free;
+    std::vector<T *> _free;
+};
+
+template <typename T> constexpr size_t Pool<T>::DefaultMaxFree;
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_POOL_H
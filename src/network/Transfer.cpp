@@ -0,0 +1,106 @@
+#include "Transfer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/uio.h>
+
+#include <afina/execute/Output.h>
+
+#include "protocol/Session.h"
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// Number of segments written at once
+constexpr size_t WriteBatch = 64;
+
+// Coroutine could wake up on another thread, while compiler is free to reuse address of errno got before the wait.
+// So errno is read by the function that never waits
+__attribute__((noinline)) int LastError() { return errno; }
+
+} // namespace
+
+// See Transfer.h
+ssize_t Receive(int socket, Input &input, std::unique_ptr<Protocol::Session> &session,
+                const std::shared_ptr<Afina::Storage> &storage, Execute::Output &output, const Wait &wait,
+                std::unique_ptr<Protocol::Session> *reuse) {
+    while (true) {
+        // Data block session waits for is read right into its place, whatever follows lands into the buffer
+        size_t room_size = 0;
+        char *room = input.room(room_size);
+        size_t direct_size = 0;
+        char *direct = (session && input.empty()) ? session->DirectBuffer(direct_size) : nullptr;
+        struct iovec buffers[2] = {{direct, direct_size}, {room, room_size}};
+        ssize_t readed_bytes = readv(socket, buffers + (direct ? 0 : 1), direct ? 2 : 1);
+        if (readed_bytes == 0) {
+            return 0;
+        } else if (readed_bytes < 0) {
+            int error = LastError();
+            if (error != EAGAIN && error != EWOULDBLOCK) {
+                throw std::runtime_error(std::string(strerror(error)));
+            }
+
+            // Connection waiting for the next request doesn't hold a buffer, unless request is received partially
+            input.release();
+            if (!wait) {
+                return -1;
+            }
+            wait();
+            continue;
+        }
+
+        size_t buffered = readed_bytes;
+        if (direct != nullptr) {
+            size_t placed = std::min(buffered, direct_size);
+            session->DirectFilled(placed, output);
+            buffered -= placed;
+        }
+        input.filled(buffered);
+
+        // Protocol is known once client sent anything
+        if (!session) {
+            session = Protocol::Session::Detect(input.data()[0], storage,
+                                                reuse != nullptr ? std::move(*reuse) : nullptr);
+        }
+
+        // Session doesn't reference consumed data once it returns
+        if (!input.empty()) {
+            input.consume(session->Process(input.data(), input.size(), output));
+        }
+        return readed_bytes;
+    }
+}
+
+// See Transfer.h
+bool Send(int socket, Execute::Output &output, const Wait &wait) {
+    struct iovec buffers[WriteBatch];
+    while (!output.empty()) {
+        size_t count = output.prepare(buffers, WriteBatch);
+        ssize_t written = writev(socket, buffers, count);
+        if (written >= 0) {
+            output.consume(written);
+            continue;
+        }
+
+        int error = LastError();
+        if (error != EAGAIN && error != EWOULDBLOCK) {
+            throw std::runtime_error("Failed to write: " + std::string(strerror(error)));
+        }
+
+        // Socket buffer is full, client reads responses slower than sends requests
+        if (!wait) {
+            return false;
+        }
+        wait();
+    }
+    return true;
+}
+
+} // namespace Network
+} // namespace Afina
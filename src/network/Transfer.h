@@ -0,0 +1,55 @@
+#ifndef AFINA_NETWORK_TRANSFER_H
+#define AFINA_NETWORK_TRANSFER_H
+
+#include <functional>
+#include <memory>
+
+#include <sys/types.h>
+
+#include "Input.h"
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Execute {
+class Output;
+}
+namespace Protocol {
+class Session;
+}
+
+namespace Network {
+
+/**
+ * Blocks the caller until the socket is ready for the operation waiting for it, servers without waits pass empty one
+ * and wait for the socket themselves
+ */
+using Wait = std::function<void()>;
+
+/**
+ * Reads from the non-blocking socket once and runs what is read through the session, responses go to the output.
+ * Data block session waits for is read right into its place, whatever follows lands into the input. Protocol is
+ * detected by the first byte client sent, session given as reuse is taken if it speaks the same one.
+ *
+ * Once socket has nothing to read input gives its buffer back, then Receive calls wait and reads again, or returns
+ * if wait is empty. Throws std::runtime_error if read fails or session refuses the request
+ *
+ * @return number of bytes read, 0 if client closed the connection, -1 if socket has nothing and wait is empty
+ */
+ssize_t Receive(int socket, Input &input, std::unique_ptr<Protocol::Session> &session,
+                const std::shared_ptr<Afina::Storage> &storage, Execute::Output &output, const Wait &wait,
+                std::unique_ptr<Protocol::Session> *reuse = nullptr);
+
+/**
+ * Writes the whole output into the non-blocking socket. Once socket can't take more Send calls wait and writes
+ * again, or returns false if wait is empty. Throws std::runtime_error if write fails
+ *
+ * @return true if output is written completely
+ */
+bool Send(int socket, Execute::Output &output, const Wait &wait);
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_TRANSFER_H
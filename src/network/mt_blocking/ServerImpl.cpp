@@ -1,6 +1,8 @@
 #include "ServerImpl.h"
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <chrono>
 #include <cstring>
 #include <iostream>
@@ -15,15 +17,15 @@
 #include <signal.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
-#include <afina/execute/Command.h>
 #include <afina/logging/Service.h>
 
-#include "protocol/Parser.h"
+#include "protocol/Session.h"
 
 namespace Afina {
 namespace Network {
@@ -90,7 +92,7 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Socket bind() failed");
     }
 
-    if (listen(_server_socket, n_accept) == -1) {
+    if (listen(_server_socket, listen_backlog) == -1) {
         close(_server_socket);
         throw std::runtime_error("Socket listen() failed");
     }
@@ -170,79 +172,48 @@ void ServerImpl::handleConnection(std::set<int>::iterator it) {
 
     // start new handler
     _logger->debug("open new connection");
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    std::unique_ptr<Protocol::Session> session;
     int client_socket = *it;
 
     try {
         int readed_bytes = -1;
         char client_buffer[4096];
-        while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
+        Execute::Output result;
+        struct iovec output[IOV_MAX];
+        while (true) {
+            // Data block session waits for is read right into its place, whatever follows lands into the buffer
+            size_t direct_size = 0;
+            char *direct = session ? session->DirectBuffer(direct_size) : nullptr;
+            struct iovec input[2] = {{direct, direct_size}, {client_buffer, sizeof(client_buffer)}};
+            if ((readed_bytes = readv(client_socket, input + (direct ? 0 : 1), direct ? 2 : 1)) <= 0) {
+                break;
+            }
             _logger->debug("Got {} bytes from socket", readed_bytes);
 
-            // Single block of data readed from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (readed_bytes > 0) {
-                _logger->debug("Process {} bytes", readed_bytes);
-                // There is no command yet
-                if (!command_to_execute) {
-
-                    std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, readed_bytes, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
-                        if (arg_remains > 0) {
-                            arg_remains += 2;
-                        }
-                    }
-                    // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
-                    } else {
-                        std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                        readed_bytes -= parsed;
-                    }
-                }
-
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                    argument_for_command.append(client_buffer, to_read);
-
-                    std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
-                    arg_remains -= to_read;
-                    readed_bytes -= to_read;
-                }
-
-                // Thre is command & argument - RUN!
-                if (command_to_execute && arg_remains == 0) {
-
-                    _logger->debug("Start command execution");
+            size_t buffered = readed_bytes;
+            if (direct != nullptr) {
+                size_t placed = std::min(buffered, direct_size);
+                session->DirectFilled(placed, result);
+                buffered -= placed;
+            }
 
-                    std::string result;
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+            if (!session) {
+                session = Protocol::Session::Detect(client_buffer[0], pStorage);
+            }
 
-                    // Send response
-                    result += "\r\n";
-                    if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                        throw std::runtime_error("Failed to send response");
-                    }
+            // Session keeps incomplete requests by itself, so whole buffer is consumed every time
+            if (buffered > 0) {
+                session->Process(client_buffer, buffered, result);
+            }
 
-                    // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
+            // Send responses, segments go in batches of IOV_MAX
+            while (!result.empty()) {
+                ssize_t sent = writev(client_socket, output, result.prepare(output, IOV_MAX));
+                if (sent <= 0) {
+                    throw std::runtime_error("Failed to send response");
                 }
-            } // while (readed_bytes)
+                result.consume(sent);
+            }
         }
 
         if (readed_bytes == 0) {
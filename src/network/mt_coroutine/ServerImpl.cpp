@@ -0,0 +1,215 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/coroutine/Scheduler.h>
+#include <afina/execute/Output.h>
+#include <afina/logging/Service.h>
+
+#include "network/Input.h"
+#include "network/Transfer.h"
+#include "protocol/RespSession.h"
+#include "protocol/Session.h"
+
+namespace Afina {
+namespace Network {
+namespace MTcoroutine {
+
+namespace {
+
+// Coroutine could wake up on another thread, while compiler is free to reuse address of errno got before the wait.
+// So errno is read by the function that never waits
+__attribute__((noinline)) int LastError() { return errno; }
+
+} // namespace
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _resp_port(0), _reuse_port(false), _stopping(false) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start mt_coroutine network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    _scheduler.reset(new Afina::Coroutine::Scheduler(n_workers));
+
+    // Single acceptor coroutine per socket, they are cheap. With SO_REUSEPORT every worker gets own sockets, so
+    // kernel spreads connections between acceptors started on the different workers
+    if (_resp_port != 0) {
+        _logger->info("Listen for RESP clients on {}", _resp_port);
+    }
+    size_t n_sockets = _reuse_port ? std::max(1u, n_workers) : 1;
+    for (size_t i = 0; i < n_sockets; i++) {
+        _server_sockets.push_back(Listen(port));
+        _scheduler->run(Accept, *this, int(_server_sockets.back()), false);
+        if (_resp_port != 0) {
+            _server_sockets.push_back(Listen(_resp_port));
+            _scheduler->run(Accept, *this, int(_server_sockets.back()), true);
+        }
+    }
+    _scheduler->Start();
+}
+
+// See Server.h
+void ServerImpl::ListenResp(uint16_t port) { _resp_port = port; }
+
+// See Server.h
+void ServerImpl::ReusePort() { _reuse_port = true; }
+
+// See ServerImpl.h
+int ServerImpl::Listen(uint16_t port) {
+    // Create server socket
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    int server_socket = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (setsockopt(server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (_reuse_port && setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(server_socket, listen_backlog) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    return server_socket;
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+
+    // Shut down socket reports an event, so every coroutine waiting for it wakes up
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+    for (int server_socket : _server_sockets) {
+        shutdown(server_socket, SHUT_RDWR);
+    }
+    for (int client_socket : _connections) {
+        shutdown(client_socket, SHUT_RDWR);
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    // Scheduler stops once every coroutine is done
+    _scheduler->Join();
+    for (int socket : _server_sockets) {
+        close(socket);
+    }
+    _server_sockets.clear();
+}
+
+// See ServerImpl.h
+void ServerImpl::Accept(ServerImpl &server, int server_socket, bool resp) {
+    while (!server._stopping) {
+        int client_socket = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket == -1) {
+            int error = LastError();
+            if (error != EAGAIN && error != EWOULDBLOCK && error != EINTR && error != ECONNABORTED &&
+                !server._stopping) {
+                server._logger->error("Failed to accept socket: {}", strerror(error));
+            }
+            if (error != EINTR && error != ECONNABORTED) {
+                server._scheduler->wait(server_socket, EPOLLIN);
+            }
+            continue;
+        }
+        server._logger->debug("Accepted connection on descriptor {}", client_socket);
+
+        {
+            // Connection accepted along with stop is closed right away
+            std::lock_guard<std::mutex> lock(server._mutex);
+            server._connections.insert(client_socket);
+            if (server._stopping) {
+                shutdown(client_socket, SHUT_RDWR);
+            }
+        }
+
+        // Coroutine goes to the worker acceptor runs on, idle workers take it from there
+        if (!server._scheduler->run(Serve, server, int(client_socket), bool(resp))) {
+            server._logger->error("Failed to start coroutine for connection on descriptor {}", client_socket);
+            std::lock_guard<std::mutex> lock(server._mutex);
+            server._connections.erase(client_socket);
+            close(client_socket);
+        }
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::Serve(ServerImpl &server, int client_socket, bool resp) {
+    std::unique_ptr<Protocol::Session> session;
+    if (resp) {
+        session.reset(new Protocol::RespSession(server.pStorage));
+    }
+    Input input;
+    Execute::Output output;
+
+    Wait wait_read = [&server, client_socket]() { server._scheduler->wait(client_socket, EPOLLIN | EPOLLRDHUP); };
+    Wait wait_write = [&server, client_socket]() { server._scheduler->wait(client_socket, EPOLLOUT); };
+    try {
+        ssize_t readed_bytes;
+        while ((readed_bytes = Receive(client_socket, input, session, server.pStorage, output, wait_read)) > 0) {
+            server._logger->debug("Got {} bytes from socket", readed_bytes);
+            Send(client_socket, output, wait_write);
+        }
+        server._logger->debug("Connection closed");
+    } catch (std::runtime_error &ex) {
+        server._logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
+    }
+
+    std::lock_guard<std::mutex> lock(server._mutex);
+    server._connections.erase(client_socket);
+    close(client_socket);
+}
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,87 @@
+#ifndef AFINA_NETWORK_MT_COROUTINE_SERVER_H
+#define AFINA_NETWORK_MT_COROUTINE_SERVER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/coroutine/Scheduler.h
+namespace Coroutine {
+class Scheduler;
+}
+
+namespace Network {
+namespace MTcoroutine {
+
+/**
+ * # Network resource manager implementation
+ * Coroutine based server on M:N scheduler: every connection is served by own coroutine doing plain read, execute
+ * and write, scheduler runs coroutines on all cores and idle cores take them from busy ones. So connections aren't
+ * tied to the thread that accepted them
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void ListenResp(uint16_t port) override;
+
+    // See Server.h
+    void ReusePort() override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+protected:
+    // Opens non-blocking socket listening on the given port
+    int Listen(uint16_t port);
+
+    // Coroutines: acceptor starts coroutine serving each connection it accepts
+    static void Accept(ServerImpl &server, int server_socket, bool resp);
+    static void Serve(ServerImpl &server, int client_socket, bool resp);
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Port to accept Redis protocol clients on, 0 if they aren't served
+    uint16_t _resp_port;
+
+    // Every worker has own SO_REUSEPORT sockets and acceptors instead of the shared ones
+    bool _reuse_port;
+
+    // Sockets acceptors wait for connections on
+    std::vector<int> _server_sockets;
+
+    // Runs coroutines on worker threads
+    std::unique_ptr<Afina::Coroutine::Scheduler> _scheduler;
+
+    // Set on stop, acceptors exit as soon as they wake up. Sockets of the connections being served are shut down
+    // then, so their coroutines read end of the stream and exit
+    std::mutex _mutex;
+    std::atomic<bool> _stopping;
+    std::unordered_set<int> _connections;
+};
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_COROUTINE_SERVER_H
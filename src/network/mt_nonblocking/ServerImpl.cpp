@@ -24,13 +24,15 @@
 #include "Connection.h"
 #include "Utils.h"
 #include "Worker.h"
+#include "protocol/RespSession.h"
 
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _server_socket(-1), _resp_port(0), _resp_socket(-1), _reuse_port(false), _next_worker(0) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -47,6 +49,59 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
+    // Start IO workers
+    _event_fd = eventfd(0, EFD_NONBLOCK);
+    if (_event_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    if (_reuse_port) {
+        // Every worker accepts on its own sockets, kernel spreads connections between them
+        _logger->info("Every worker listens on its own SO_REUSEPORT socket");
+        _workers.reserve(n_workers);
+        for (int i = 0; i < n_workers; i++) {
+            int server_socket = Listen(port);
+            _worker_sockets.push_back(server_socket);
+
+            int resp_socket = -1;
+            if (_resp_port != 0) {
+                resp_socket = Listen(_resp_port);
+                _worker_sockets.push_back(resp_socket);
+            }
+
+            _workers.emplace_back(pStorage, pLogging);
+            _workers.back().Start(_event_fd, server_socket, resp_socket);
+        }
+        return;
+    }
+
+    _server_socket = Listen(port);
+    if (_resp_port != 0) {
+        _logger->info("Listen for RESP clients on {}", _resp_port);
+        _resp_socket = Listen(_resp_port);
+    }
+
+    _workers.reserve(n_workers);
+    for (int i = 0; i < n_workers; i++) {
+        _workers.emplace_back(pStorage, pLogging);
+        _workers.back().Start(_event_fd);
+    }
+
+    // Start acceptors
+    _acceptors.reserve(n_acceptors);
+    for (int i = 0; i < n_acceptors; i++) {
+        _acceptors.emplace_back(&ServerImpl::OnRun, this);
+    }
+}
+
+// See Server.h
+void ServerImpl::ListenResp(uint16_t port) { _resp_port = port; }
+
+// See Server.h
+void ServerImpl::ReusePort() { _reuse_port = true; }
+
+// See ServerImpl.h
+int ServerImpl::Listen(uint16_t port) {
     // Create server socket
     struct sockaddr_in server_addr;
     std::memset(&server_addr, 0, sizeof(server_addr));
@@ -54,57 +109,39 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
     server_addr.sin_port = htons(port);       // TCP port number
     server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
 
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
+    int server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (server_socket == -1) {
         throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
     }
 
     int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
     }
 
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
-    }
-
-    make_socket_non_blocking(_server_socket);
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
-        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
-    }
-
-    // Start IO workers
-    _data_epoll_fd = epoll_create1(0);
-    if (_data_epoll_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    if (setsockopt(server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
     }
 
-    _event_fd = eventfd(0, EFD_NONBLOCK);
-    if (_event_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    if (_reuse_port && setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
     }
 
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.ptr = nullptr;
-    if (epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
-        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
     }
 
-    _workers.reserve(n_workers);
-    for (int i = 0; i < n_workers; i++) {
-        _workers.emplace_back(pStorage, pLogging);
-        _workers.back().Start(_data_epoll_fd);
+    make_socket_non_blocking(server_socket);
+    if (listen(server_socket, listen_backlog) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
     }
 
-    // Start acceptors
-    _acceptors.reserve(n_acceptors);
-    for (int i = 0; i < n_acceptors; i++) {
-        _acceptors.emplace_back(&ServerImpl::OnRun, this);
-    }
+    return server_socket;
 }
 
 // See Server.h
@@ -126,10 +163,19 @@ void ServerImpl::Join() {
     for (auto &t : _acceptors) {
         t.join();
     }
+    if (_server_socket != -1) {
+        close(_server_socket);
+    }
+    if (_resp_socket != -1) {
+        close(_resp_socket);
+    }
 
     for (auto &w : _workers) {
         w.Join();
     }
+    for (int socket : _worker_sockets) {
+        close(socket);
+    }
 }
 
 // See ServerImpl.h
@@ -154,6 +200,15 @@ void ServerImpl::OnRun() {
         throw std::runtime_error("Failed to add file descriptor to epoll");
     }
 
+    if (_resp_socket != -1) {
+        struct epoll_event event3;
+        event3.events = EPOLLIN | EPOLLEXCLUSIVE;
+        event3.data.fd = _resp_socket;
+        if (epoll_ctl(acceptor_epoll, EPOLL_CTL_ADD, _resp_socket, &event3)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+    }
+
     bool run = true;
     std::array<struct epoll_event, 64> mod_list;
     while (run) {
@@ -168,46 +223,26 @@ void ServerImpl::OnRun() {
                 continue;
             }
 
+            int server_socket = current_event.data.fd;
             for (;;) {
-                struct sockaddr in_addr;
-                socklen_t in_len;
-
-                // No need to make these sockets non blocking since accept4() takes care of it.
-                in_len = sizeof in_addr;
-                int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                int infd = accept_connection(server_socket, *_logger);
                 if (infd == -1) {
-                    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-                        break; // We have processed all incoming connections.
-                    } else {
-                        _logger->error("Failed to accept socket");
-                        break;
-                    }
-                }
-
-                // Print host and service info.
-                char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-                int retval = getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf,
-                                         NI_NUMERICHOST | NI_NUMERICSERV);
-                if (retval == 0) {
-                    _logger->info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
+                    break; // We have processed all incoming connections.
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd);
-                if (pc == nullptr) {
-                    throw std::runtime_error("Failed to allocate connection");
+                std::unique_ptr<Protocol::Session> session;
+                if (server_socket == _resp_socket) {
+                    session.reset(new Protocol::RespSession(pStorage));
                 }
 
-                // Register connection in worker's epoll
+                // Register connection in epoll of the next worker
+                Worker &worker = _workers[_next_worker.fetch_add(1, std::memory_order_relaxed) % _workers.size()];
+                Connection *pc = worker.NewConnection(infd, _logger, std::move(session));
                 pc->Start();
-                if (pc->isAlive()) {
-                    pc->_event.events |= EPOLLONESHOT;
-                    int epoll_ctl_retval;
-                    if ((epoll_ctl_retval = epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event))) {
-                        _logger->debug("epoll_ctl failed during connection register in workers'epoll: error {}", epoll_ctl_retval);
-                        pc->OnError();
-                        delete pc;
-                    }
+                if (!worker.Adopt(pc)) {
+                    pc->OnError();
+                    worker.Release(pc);
                 }
             }
         }
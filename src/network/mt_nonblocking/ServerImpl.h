@@ -1,6 +1,7 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <atomic>
 #include <thread>
 #include <vector>
 
@@ -29,6 +30,12 @@ public:
     // See Server.h
     void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
 
+    // See Server.h
+    void ListenResp(uint16_t port) override;
+
+    // See Server.h
+    void ReusePort() override;
+
     // See Server.h
     void Stop() override;
 
@@ -39,6 +46,9 @@ protected:
     void OnRun();
     void OnNewConnection();
 
+    // Opens non-blocking socket listening on the given port, with SO_REUSEPORT if workers listen by themselves
+    int Listen(uint16_t port);
+
 private:
     // logger to use
     std::shared_ptr<spdlog::logger> _logger;
@@ -51,18 +61,26 @@ private:
     // Socket to accept new connection on, shared between acceptors
     int _server_socket;
 
+    // Port and socket to accept Redis protocol clients on, 0 and -1 if they aren't served
+    uint16_t _resp_port;
+    int _resp_socket;
+
     // Threads that accepts new connections, each has private epoll instance
     // but share global server socket
     std::vector<std::thread> _acceptors;
 
-    // EPOLL instance shared between workers
-    int _data_epoll_fd;
+    // Every worker accepts connections on its own sockets instead of acceptors, see ReusePort
+    bool _reuse_port;
+    std::vector<int> _worker_sockets;
 
     // Curstom event "device" used to wakeup workers
     int _event_fd;
 
-    // threads serving read/write requests
+    // threads serving read/write requests, each has private epoll instance
     std::vector<Worker> _workers;
+
+    // Acceptors hand new connections over to workers round-robin
+    std::atomic<uint32_t> _next_worker;
 };
 
 } // namespace MTnonblock
@@ -2,12 +2,16 @@
 
 #include <stdexcept>
 
+#include <errno.h>
 #include <fcntl.h>
+#include <netdb.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <spdlog/logger.h>
+
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
@@ -27,6 +31,30 @@ void make_socket_non_blocking(int sfd) {
     }
 }
 
+int accept_connection(int server_socket, spdlog::logger &logger) {
+    struct sockaddr in_addr;
+    socklen_t in_len;
+
+    // No need to make these sockets non blocking since accept4() takes care of it.
+    in_len = sizeof in_addr;
+    int infd = accept4(server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (infd == -1) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            logger.error("Failed to accept socket");
+        }
+        return -1;
+    }
+
+    // Print host and service info.
+    char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+    int retval =
+        getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
+    if (retval == 0) {
+        logger.info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
+    }
+    return infd;
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
@@ -1,12 +1,22 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_UTILS_H
 #define AFINA_NETWORK_MT_NONBLOCKING_UTILS_H
 
+namespace spdlog {
+class logger;
+}
+
 namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
 void make_socket_non_blocking(int sfd);
 
+/**
+ * Accepts next connection on the non-blocking server socket. Returns descriptor of the new non-blocking socket,
+ * or -1 once there are no more connections to accept
+ */
+int accept_connection(int server_socket, spdlog::logger &logger);
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
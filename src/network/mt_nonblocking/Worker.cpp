@@ -1,13 +1,16 @@
 #include "Worker.h"
 
 #include <cassert>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
 
 #include <netdb.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <spdlog/logger.h>
 
@@ -15,6 +18,7 @@
 
 #include "Connection.h"
 #include "Utils.h"
+#include "protocol/RespSession.h"
 
 namespace Afina {
 namespace Network {
@@ -22,9 +26,8 @@ namespace MTnonblock {
 
 // See Worker.h
 Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
-    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1) {
-    // TODO: implementation here
-}
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _epoll_fd(-1), _server_sockets{-1, -1},
+      _pool(new Pool<Connection>()) {}
 
 // See Worker.h
 Worker::~Worker() {
@@ -41,21 +44,73 @@ Worker &Worker::operator=(Worker &&other) {
     _logger = std::move(other._logger);
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _server_sockets[0] = other._server_sockets[0];
+    _server_sockets[1] = other._server_sockets[1];
+    _pool = std::move(other._pool);
 
     other._epoll_fd = -1;
     return *this;
 }
 
 // See Worker.h
-void Worker::Start(int epoll_fd) {
+void Worker::Start(int event_fd, int server_socket, int resp_socket) {
     if (isRunning.exchange(true) == false) {
         assert(_epoll_fd == -1);
-        _epoll_fd = epoll_fd;
+        _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll_fd == -1) {
+            throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+        }
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, event_fd, &event)) {
+            throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+        }
+
+        _server_sockets[0] = server_socket;
+        _server_sockets[1] = resp_socket;
+        for (int &socket : _server_sockets) {
+            if (socket == -1) {
+                continue;
+            }
+
+            event.events = EPOLLIN;
+            event.data.ptr = &socket;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, socket, &event)) {
+                throw std::runtime_error("Failed to add server socket to epoll");
+            }
+        }
+
         _logger = _pLogging->select("network.worker");
         _thread = std::thread(&Worker::OnRun, this);
     }
 }
 
+// See Worker.h
+bool Worker::Adopt(Connection *pc) {
+    // Connection is registered once for everything it could ever want, edge triggered events are reported only on
+    // change so there is nothing to rearm or modify later on
+    int epoll_ctl_retval;
+    if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event))) {
+        _logger->debug("epoll_ctl failed during connection register in worker's epoll: error {}", epoll_ctl_retval);
+        return false;
+    }
+    return true;
+}
+
+// See Worker.h
+Connection *Worker::NewConnection(int s, std::shared_ptr<spdlog::logger> pl,
+                                  std::unique_ptr<Protocol::Session> pss) {
+    return _pool->Get(s, _pStorage, std::move(pl), std::move(pss));
+}
+
+// See Worker.h
+void Worker::Release(Connection *pc) {
+    pc->Close();
+    _pool->Put(pc);
+}
+
 // See Worker.h
 void Worker::Stop() { isRunning = false; }
 
@@ -63,6 +118,8 @@ void Worker::Stop() { isRunning = false; }
 void Worker::Join() {
     assert(_thread.joinable());
     _thread.join();
+    close(_epoll_fd);
+    _epoll_fd = -1;
 }
 
 // See Worker.h
@@ -71,13 +128,9 @@ void Worker::OnRun() {
     _logger->trace("OnRun");
 
     // Process connection events
-    //
-    // Do not forget to use EPOLLEXCLUSIVE flag when register socket
-    // for events to avoid thundering herd type behavior.
-    int timeout = -1;
     std::array<struct epoll_event, 64> mod_list;
     while (isRunning) {
-        int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), timeout);
+        int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), -1);
         _logger->debug("Worker wokeup: {} events", nmod);
 
         for (int i = 0; i < nmod; i++) {
@@ -90,6 +143,12 @@ void Worker::OnRun() {
                 continue;
             }
 
+            // New connections on the socket worker listens by itself
+            if (current_event.data.ptr == &_server_sockets[0] || current_event.data.ptr == &_server_sockets[1]) {
+                OnAccept(*static_cast<int *>(current_event.data.ptr));
+                continue;
+            }
+
             // Some connection gets new data
             Connection *pconn = static_cast<Connection *>(current_event.data.ptr);
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
@@ -99,40 +158,48 @@ void Worker::OnRun() {
                 _logger->debug("Got EPOLLRDHUP, value of returned events: {}", current_event.events);
                 pconn->OnClose();
             } else {
-                // Depends on what connection wants...
                 if (current_event.events & EPOLLIN) {
                     _logger->trace("Got EPOLLIN");
                     pconn->DoRead();
                 }
-                if (current_event.events & EPOLLOUT) {
-                    _logger->trace("Got EPOLLOUT");
-                    pconn->DoWrite();
-                }
-            }
 
-            // Rearm connection
-            if (pconn->isAlive()) {
-                pconn->_event.events |= EPOLLONESHOT;
-                int epoll_ctl_retval;
-                if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event))) {
-                    _logger->debug("epoll_ctl failed during connection rearm: error {}", epoll_ctl_retval);
-                    pconn->OnError();
-                    delete pconn;
-                }
+                // Socket which is writable already doesn't report EPOLLOUT again, so responses are written right
+                // after the read. Whatever doesn't fit into the socket waits for EPOLLOUT
+                _logger->trace("Write pending output");
+                pconn->DoWrite();
             }
-            // Or delete closed one
-            else {
-                if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
-                    std::cerr << "Failed to delete connection!" << std::endl;
-                }
-                delete pconn;
+
+            // Closing the socket removes it from the epoll as well
+            if (!pconn->isAlive()) {
+                Release(pconn);
             }
         }
-        // TODO: Select timeout...
     }
     _logger->warn("Worker stopped");
 }
 
+// See Worker.h
+void Worker::OnAccept(int server_socket) {
+    for (;;) {
+        int infd = accept_connection(server_socket, *_logger);
+        if (infd == -1) {
+            break; // We have processed all incoming connections.
+        }
+
+        std::unique_ptr<Protocol::Session> session;
+        if (server_socket == _server_sockets[1]) {
+            session.reset(new Protocol::RespSession(_pStorage));
+        }
+
+        Connection *pc = NewConnection(infd, _logger, std::move(session));
+        pc->Start();
+        if (!Adopt(pc)) {
+            pc->OnError();
+            Release(pc);
+        }
+    }
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
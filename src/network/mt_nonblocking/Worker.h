@@ -5,6 +5,8 @@
 #include <memory>
 #include <thread>
 
+#include "network/Pool.h"
+
 namespace spdlog {
 class logger;
 }
@@ -16,14 +18,21 @@ class Storage;
 namespace Logging {
 class Service;
 }
+namespace Protocol {
+class Session;
+}
 
 namespace Network {
 namespace MTnonblock {
 
+// Forward declaration, see Connection.h
+class Connection;
+
 /**
  * # Thread running epoll
- * On Start spaws background thread that is doing epoll on the given server
- * socket and process incoming connections and its data
+ * On Start spaws background thread that is doing epoll on its own set of connections and process their data.
+ * Connection handed over to the worker is served by its thread only, so connections need no locking and events
+ * are edge triggered: nothing has to be rearmed after each one
  */
 class Worker {
 public:
@@ -34,11 +43,30 @@ public:
     Worker &operator=(Worker &&);
 
     /**
-     * Spaws new background thread that is doing epoll on the given server
-     * socket. Once connection accepted it must be registered and being processed
-     * on this thread
+     * Creates epoll instance of the worker and spaws new background thread that is doing epoll on it. Besides
+     * connections worker watches given eventfd, server signals it to wake workers up.
+     *
+     * If server sockets are given worker accepts connections on them by itself, RESP clients on resp_socket
+     */
+    void Start(int event_fd, int server_socket = -1, int resp_socket = -1);
+
+    /**
+     * Hand connection over to the worker, from now on it is served on the worker thread. Could be called from any
+     * thread. Returns false if connection can't be registered, caller keeps ownership in such case
+     */
+    bool Adopt(Connection *pc);
+
+    /**
+     * Returns connection to be adopted by the worker, closed one is reused if there is any. Could be called from
+     * any thread
      */
-    void Start(int epoll_fd);
+    Connection *NewConnection(int s, std::shared_ptr<spdlog::logger> pl,
+                              std::unique_ptr<Protocol::Session> pss = nullptr);
+
+    /**
+     * Closes connection and keeps it for reuse. Could be called from any thread
+     */
+    void Release(Connection *pc);
 
     /**
      * Signal background thread to stop. After that signal thread must stop to
@@ -60,6 +88,11 @@ protected:
      */
     void OnRun();
 
+    /**
+     * Accepts all pending connections on the given server socket and serves them in this worker
+     */
+    void OnAccept(int server_socket);
+
 private:
     Worker(Worker &) = delete;
     Worker &operator=(Worker &) = delete;
@@ -79,8 +112,15 @@ private:
     // Thread serving requests in this worker
     std::thread _thread;
 
-    // EPOLL descriptor using for events processing
+    // EPOLL descriptor using for events processing, owned by the worker
     int _epoll_fd;
+
+    // Sockets worker accepts connections on by itself, memcached and RESP ones, -1 if there is no one. Epoll
+    // events of those sockets point to the array items
+    int _server_sockets[2];
+
+    // Closed connections of the worker, reused for the new clients
+    std::unique_ptr<Pool<Connection>> _pool;
 };
 
 } // namespace MTnonblock
@@ -0,0 +1,66 @@
+#ifndef AFINA_NETWORK_ST_COROUTINE_SERVER_H
+#define AFINA_NETWORK_ST_COROUTINE_SERVER_H
+
+#include <memory>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace STcoroutine {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Network resource manager implementation
+ * Coroutine based server: single thread serves every connection by its own coroutine
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void ListenResp(uint16_t port) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+protected:
+    // Opens non-blocking socket listening on the given port
+    int Listen(uint16_t port);
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Socket to accept new connection on
+    int _server_socket;
+
+    // Port and socket to accept Redis protocol clients on, 0 and -1 if they aren't served
+    uint16_t _resp_port;
+    int _resp_socket;
+
+    // Custom event "device" used to wakeup worker
+    int _event_fd;
+
+    // IO thread
+    std::unique_ptr<Worker> _worker;
+};
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_ST_COROUTINE_SERVER_H
@@ -0,0 +1,224 @@
+#include "Worker.h"
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/coroutine/Engine.h>
+#include <afina/execute/Output.h>
+#include <afina/logging/Service.h>
+
+#include "network/Input.h"
+#include "network/Transfer.h"
+#include "protocol/RespSession.h"
+#include "protocol/Session.h"
+
+namespace Afina {
+namespace Network {
+namespace STcoroutine {
+
+namespace {
+
+// Coroutines switch on every socket wait, so each one gets its own stack where platform allows to
+#if defined(__x86_64__)
+constexpr Afina::Coroutine::Engine::Stacks CoroutineStacks = Afina::Coroutine::Engine::Stacks::Dedicated;
+#else
+constexpr Afina::Coroutine::Engine::Stacks CoroutineStacks = Afina::Coroutine::Engine::Stacks::Copied;
+#endif
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _engine(nullptr), _epoll_descr(-1), _server_socket(-1),
+      _resp_socket(-1), _event_fd(-1), _stopping(false) {}
+
+// See Worker.h
+Worker::~Worker() {}
+
+// See Worker.h
+void Worker::Start(int event_fd, int server_socket, int resp_socket) {
+    if (isRunning.exchange(true) == false) {
+        _event_fd = event_fd;
+        _server_socket = server_socket;
+        _resp_socket = resp_socket;
+        _stopping = false;
+
+        _logger = _pLogging->select("network.worker");
+        _thread = std::thread(&Worker::OnRun, this);
+    }
+}
+
+// See Worker.h
+void Worker::Stop() { isRunning = false; }
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    _logger->trace("OnRun");
+
+    _epoll_descr = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_descr == -1) {
+        _logger->error("Failed to create epoll file descriptor: {}", strerror(errno));
+        return;
+    }
+
+    // Events without coroutine come from the server
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(_epoll_descr, EPOLL_CTL_ADD, _event_fd, &event)) {
+        _logger->error("Failed to add file descriptor to epoll: {}", strerror(errno));
+        close(_epoll_descr);
+        return;
+    }
+
+    // Engine returns once every coroutine is done, which happens only after stop
+    Afina::Coroutine::Engine engine([this](Afina::Coroutine::Engine &) { Poll(); }, CoroutineStacks);
+    _engine = &engine;
+    engine.start(Main, *this);
+    _engine = nullptr;
+
+    close(_epoll_descr);
+    _epoll_descr = -1;
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::Poll() {
+    std::array<struct epoll_event, 64> events;
+    int nevents = epoll_wait(_epoll_descr, events.data(), events.size(), -1);
+    if (nevents == -1) {
+        if (errno != EINTR) {
+            _logger->error("Failed to wait for events: {}", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; i < nevents; i++) {
+        if (events[i].data.ptr != nullptr) {
+            _engine->unblock(events[i].data.ptr);
+            continue;
+        }
+
+        // Eventfd is shared by all workers and never read, server signals it once
+        if (isRunning || _stopping) {
+            continue;
+        }
+        _logger->debug("Stop due to stop signal");
+        _stopping = true;
+        if (epoll_ctl(_epoll_descr, EPOLL_CTL_DEL, _event_fd, nullptr)) {
+            _logger->error("Failed to delete eventfd from epoll: {}", strerror(errno));
+        }
+
+        // Acceptors exit once they see stop, connections read end of the stream and close
+        for (void *acceptor : _acceptors) {
+            _engine->unblock(acceptor);
+        }
+        for (int client_socket : _connections) {
+            shutdown(client_socket, SHUT_RDWR);
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Wait() { _engine->block(); }
+
+// See Worker.h
+void Worker::Main(Worker &worker) {
+    for (int server_socket : {worker._server_socket, worker._resp_socket}) {
+        if (server_socket == -1) {
+            continue;
+        }
+
+        void *acceptor = worker._engine->run(Accept, worker, int(server_socket));
+        worker._acceptors.push_back(acceptor);
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = acceptor;
+        if (epoll_ctl(worker._epoll_descr, EPOLL_CTL_ADD, server_socket, &event)) {
+            // Exceptions can't leave coroutine, acceptor just waits for stop then
+            worker._logger->error("Failed to add server socket to epoll: {}", strerror(errno));
+        }
+    }
+}
+
+// See Worker.h
+void Worker::Accept(Worker &worker, int server_socket) {
+    bool resp = (server_socket == worker._resp_socket);
+    while (!worker._stopping) {
+        int client_socket = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+                worker._logger->error("Failed to accept socket: {}", strerror(errno));
+            }
+            if (errno != EINTR && errno != ECONNABORTED) {
+                worker.Wait();
+            }
+            continue;
+        }
+        worker._logger->debug("Accepted connection on descriptor {}", client_socket);
+
+        // Coroutine gets control once acceptor blocks, socket events wake it up from then on
+        void *routine = worker._engine->run(Serve, worker, int(client_socket), bool(resp));
+        worker._connections.insert(client_socket);
+
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = routine;
+        if (epoll_ctl(worker._epoll_descr, EPOLL_CTL_ADD, client_socket, &event)) {
+            // Coroutine finds socket closed and exits without waiting
+            worker._logger->error("Failed to add connection to epoll: {}", strerror(errno));
+            shutdown(client_socket, SHUT_RDWR);
+        }
+    }
+
+    // Coroutine is gone, nothing should point to it anymore
+    if (epoll_ctl(worker._epoll_descr, EPOLL_CTL_DEL, server_socket, nullptr)) {
+        worker._logger->error("Failed to delete server socket from epoll: {}", strerror(errno));
+    }
+}
+
+// See Worker.h
+void Worker::Serve(Worker &worker, int client_socket, bool resp) {
+    std::unique_ptr<Protocol::Session> session;
+    if (resp) {
+        session.reset(new Protocol::RespSession(worker._pStorage));
+    }
+    Input input;
+    Execute::Output output;
+
+    Network::Wait wait = [&worker]() { worker.Wait(); };
+    try {
+        ssize_t readed_bytes;
+        while ((readed_bytes = Receive(client_socket, input, session, worker._pStorage, output, wait)) > 0) {
+            worker._logger->debug("Got {} bytes from socket", readed_bytes);
+            Send(client_socket, output, wait);
+        }
+        worker._logger->debug("Connection closed");
+    } catch (std::runtime_error &ex) {
+        worker._logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
+    }
+
+    // Closed socket leaves epoll, so no event points to the coroutine once it is done
+    worker._connections.erase(client_socket);
+    close(client_socket);
+}
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
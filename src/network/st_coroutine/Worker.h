@@ -0,0 +1,119 @@
+#ifndef AFINA_NETWORK_ST_COROUTINE_WORKER_H
+#define AFINA_NETWORK_ST_COROUTINE_WORKER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+namespace Coroutine {
+class Engine;
+}
+
+namespace Network {
+namespace STcoroutine {
+
+/**
+ * # Thread running coroutines
+ * On Start spawns background thread with its own coroutine engine and epoll. Every connection is served by the
+ * coroutine doing plain read, execute and write one after another. Once socket has nothing to read or can't take more
+ * data coroutine blocks, engine passes control to the ones ready to run and, once there is no such, polls for sockets
+ * the blocked coroutines wait for
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    ~Worker();
+
+    /**
+     * Spawns new background thread that accepts connections on the given non-blocking server socket, RESP clients
+     * on resp_socket if there is one. Besides them worker watches given eventfd, server signals it to wake workers up
+     */
+    void Start(int event_fd, int server_socket, int resp_socket = -1);
+
+    /**
+     * Signal background thread to stop. Thread stops to accept new connections, shuts down ones it serves and exits
+     * once their coroutines are done
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one for this worker is actually been destroyed
+     */
+    void Join();
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+    /**
+     * Unblocker of the engine: waits for events on the sockets and unblocks coroutines waiting for them
+     */
+    void Poll();
+
+    /**
+     * Blocks the current coroutine until its socket reports any event
+     */
+    void Wait();
+
+    // Coroutines: the first one starts acceptors, acceptor starts coroutine serving each connection it accepts
+    static void Main(Worker &worker);
+    static void Accept(Worker &worker, int server_socket);
+    static void Serve(Worker &worker, int client_socket, bool resp);
+
+private:
+    Worker(Worker &) = delete;
+    Worker &operator=(Worker &) = delete;
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+
+    // afina services
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+
+    // Logger to be used
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Thread serving requests in this worker
+    std::thread _thread;
+
+    // Engine and epoll of the thread, events point to the coroutines waiting for them
+    Afina::Coroutine::Engine *_engine;
+    int _epoll_descr;
+
+    // Sockets worker accepts connections on, memcached and RESP ones, -1 if there is no one
+    int _server_socket;
+    int _resp_socket;
+
+    // Eventfd server wakes workers up with
+    int _event_fd;
+
+    // Set once worker got stop signal, acceptors exit as soon as they wake up
+    bool _stopping;
+
+    // Acceptor coroutines and sockets of the connections being served
+    std::vector<void *> _acceptors;
+    std::unordered_set<int> _connections;
+};
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
+#endif // AFINA_NETWORK_ST_COROUTINE_WORKER_H
@@ -9,10 +9,11 @@
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
-#include <afina/execute/Command.h>
+#include <afina/execute/Output.h>
 #include <afina/logging/Service.h>
 
-#include "protocol/Parser.h"
+#include "network/Input.h"
+#include "protocol/Session.h"
 
 namespace Afina {
 namespace Network {
@@ -20,16 +21,27 @@ namespace STnonblock {
 
 class Connection {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl)
-        : _socket(s), pStorage(ps), _logger(pl) {
+    /**
+     * Connection speaks protocol of the given session, if there is no one then protocol is detected by the first
+     * byte client sends
+     */
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl,
+               std::unique_ptr<Protocol::Session> pss = nullptr)
+        : _socket(s), pStorage(ps), _logger(pl), session(std::move(pss)) {
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
-        offset = 0;
-        length = 4096;
+        alive = false;
     }
 
     inline bool isAlive() const { return alive; }
 
+    /**
+     * Prepare closed connection to serve the new client, as if it was just constructed by the same arguments.
+     * Session of the previous client is reused, buffers are borrowed from the thread pools only while in use
+     */
+    void Reset(int s, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl,
+               std::unique_ptr<Protocol::Session> pss = nullptr);
+
     void Start();
 
 protected:
@@ -45,16 +57,14 @@ private:
     struct epoll_event _event;
     // Connection States -------------------------------------------------------
     bool alive;
-    std::size_t arg_remains;
-    Protocol::Parser parser;
-    std::string argument_for_command;
     std::shared_ptr<Afina::Storage> pStorage;
     std::shared_ptr<spdlog::logger> _logger;
-    std::unique_ptr<Execute::Command> command_to_execute;
-    size_t length, offset;
-    char client_buffer[4096];
-    std::vector<std::string> result_buffer;
-    size_t last_writed_bytes;
+    std::unique_ptr<Protocol::Session> session;
+    // Session of the previous client, reused once protocol is detected
+    std::unique_ptr<Protocol::Session> spare_session;
+    // Bytes readed but not processed yet
+    Input input;
+    Execute::Output output;
     //--------------------------------------------------------------------------
 };
 
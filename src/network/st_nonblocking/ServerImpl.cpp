@@ -23,13 +23,15 @@
 
 #include "Connection.h"
 #include "Utils.h"
+#include "protocol/RespSession.h"
 
 namespace Afina {
 namespace Network {
 namespace STnonblock {
 
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _resp_port(0), _resp_socket(-1) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {}
@@ -46,6 +48,25 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Unable to mask SIGPIPE");
     }
 
+    _server_socket = Listen(port);
+    if (_resp_port != 0) {
+        _logger->info("Listen for RESP clients on {}", _resp_port);
+        _resp_socket = Listen(_resp_port);
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK);
+    if (_event_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    _work_thread = std::thread(&ServerImpl::OnRun, this);
+}
+
+// See Server.h
+void ServerImpl::ListenResp(uint16_t port) { _resp_port = port; }
+
+// See ServerImpl.h
+int ServerImpl::Listen(uint16_t port) {
     // Create server socket
     struct sockaddr_in server_addr;
     std::memset(&server_addr, 0, sizeof(server_addr));
@@ -53,39 +74,34 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
     server_addr.sin_port = htons(port);       // TCP port number
     server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
 
-    _server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (_server_socket == -1) {
+    int server_socket = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (server_socket == -1) {
         throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
     }
 
     int opts = 1;
-    if (setsockopt(_server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket setsockopt() failed");
     }
 
-    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
-        close(_server_socket);
+    if (setsockopt(server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
     }
 
-    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
-        close(_server_socket);
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
     }
 
-    make_socket_non_blocking(_server_socket);
-    if (listen(_server_socket, 5) == -1) {
-        close(_server_socket);
+    make_socket_non_blocking(server_socket);
+    if (listen(server_socket, listen_backlog) == -1) {
+        close(server_socket);
         throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
     }
 
-    _event_fd = eventfd(0, EFD_NONBLOCK);
-    if (_event_fd == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
-    }
-
-    _work_thread = std::thread(&ServerImpl::OnRun, this);
+    return server_socket;
 }
 
 // See Server.h
@@ -126,6 +142,15 @@ void ServerImpl::OnRun() {
         throw std::runtime_error("Failed to add file descriptor to epoll");
     }
 
+    if (_resp_socket != -1) {
+        struct epoll_event event3;
+        event3.events = EPOLLIN;
+        event3.data.fd = _resp_socket;
+        if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _resp_socket, &event3)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+    }
+
     bool run = true;
     std::array<struct epoll_event, 64> mod_list;
     while (run) {
@@ -138,8 +163,8 @@ void ServerImpl::OnRun() {
                 _logger->debug("Break acceptor due to stop signal");
                 run = false;
                 continue;
-            } else if (current_event.data.fd == _server_socket) {
-                OnNewConnection(epoll_descr);
+            } else if (current_event.data.fd == _server_socket || current_event.data.fd == _resp_socket) {
+                OnNewConnection(epoll_descr, current_event.data.fd);
                 continue;
             }
 
@@ -155,11 +180,12 @@ void ServerImpl::OnRun() {
             else if (current_event.events & EPOLLRDHUP) {
                 pc->OnClose();
             } else {
-                // Depends on what connection wants...
                 if (current_event.events & EPOLLIN) {
                     pc->DoRead();
                 }
-                if (current_event.events & EPOLLOUT) {
+
+                // Responses are written right after the read, EPOLLOUT is armed only if socket doesn't take them all
+                if (pc->isAlive()) {
                     pc->DoWrite();
                 }
             }
@@ -171,13 +197,13 @@ void ServerImpl::OnRun() {
                 }
                 pc->OnClose();
                 active_connections.erase(pc);
-                delete pc;
+                _connections_pool.Put(pc);
             } else if (pc->_event.events != old_mask) {
                 if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
                     _logger->error("Failed to change connection event mask");
                     pc->OnClose();
                     active_connections.erase(pc);
-                    delete pc;
+                    _connections_pool.Put(pc);
                 }
             }
         }
@@ -190,9 +216,12 @@ void ServerImpl::OnRun() {
     active_connections.clear();
     _logger->warn("Acceptor stopped");
     close(_server_socket);
+    if (_resp_socket != -1) {
+        close(_resp_socket);
+    }
 }
 
-void ServerImpl::OnNewConnection(int epoll_descr) {
+void ServerImpl::OnNewConnection(int epoll_descr, int server_socket) {
     for (;;) {
         _logger->debug("In OnNewConnection");
         struct sockaddr in_addr;
@@ -200,7 +229,7 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
 
         // No need to make these sockets non blocking since accept4() takes care of it.
         in_len = sizeof in_addr;
-        int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        int infd = accept4(server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (infd == -1) {
             if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
                 break; // We have processed all incoming connections.
@@ -219,19 +248,20 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
         }
 
         // Register the new FD to be monitored by epoll.
-        Connection *pc = new (std::nothrow) Connection(infd, pStorage, _logger);
-        active_connections.insert(pc);
-        if (pc == nullptr) {
-            throw std::runtime_error("Failed to allocate connection");
+        std::unique_ptr<Protocol::Session> session;
+        if (server_socket == _resp_socket) {
+            session.reset(new Protocol::RespSession(pStorage));
         }
+        Connection *pc = _connections_pool.Get(infd, pStorage, _logger, std::move(session));
+        active_connections.insert(pc);
 
         // Register connection in worker's epoll
         pc->Start();
         if (pc->isAlive()) {
             if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
-                pc->OnError();
+                pc->OnClose();
                 active_connections.erase(pc);
-                delete pc;
+                _connections_pool.Put(pc);
             }
         }
     }
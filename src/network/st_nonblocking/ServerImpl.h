@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Connection.h"
+#include "network/Pool.h"
 
 namespace spdlog {
 class logger;
@@ -31,6 +32,9 @@ public:
     // See Server.h
     void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
 
+    // See Server.h
+    void ListenResp(uint16_t port) override;
+
     // See Server.h
     void Stop() override;
 
@@ -39,7 +43,10 @@ public:
 
 protected:
     void OnRun();
-    void OnNewConnection(int);
+    void OnNewConnection(int epoll_descr, int server_socket);
+
+    // Opens non-blocking socket listening on the given port
+    int Listen(uint16_t port);
 
 private:
     // logger to use
@@ -53,6 +60,10 @@ private:
     // Socket to accept new connection on, shared between acceptors
     int _server_socket;
 
+    // Port and socket to accept Redis protocol clients on, 0 and -1 if they aren't served
+    uint16_t _resp_port;
+    int _resp_socket;
+
     // Curstom event "device" used to wakeup workers
     int _event_fd;
 
@@ -60,6 +71,9 @@ private:
     std::thread _work_thread;
 
     std::set<Connection *> active_connections;
+
+    // Closed connections, reused for the new clients
+    Pool<Connection> _connections_pool;
 };
 
 } // namespace STnonblock
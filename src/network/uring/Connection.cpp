@@ -0,0 +1,76 @@
+#include "Connection.h"
+
+#include <cstring>
+#include <utility>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+constexpr size_t Connection::MessageSize;
+
+// See Connection.h
+void Connection::Reset(int s, std::shared_ptr<Afina::Storage> ps, std::unique_ptr<Protocol::Session> pss) {
+    _socket = s;
+    pStorage = std::move(ps);
+    if (pss) {
+        session = std::move(pss);
+    } else if (session) {
+        spare_session = std::move(session);
+    }
+
+    pending.clear();
+    output.clear();
+    sending.clear();
+    receiving = sending_inflight = false;
+    closing = failed = queued = false;
+}
+
+// See Connection.h
+void Connection::Close() {
+    if (_socket != -1) {
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+// See Connection.h
+void Connection::OnData(const char *data, size_t size) {
+    // Protocol is known once client sent anything
+    if (!session) {
+        session = Protocol::Session::Detect(data[0], pStorage, std::move(spare_session));
+    }
+
+    // Provided buffer goes back to the kernel right away, so whatever session didn't consume is kept aside
+    if (pending.empty()) {
+        size_t consumed = session->Process(data, size, output);
+        pending.append(data + consumed, size - consumed);
+    } else {
+        pending.append(data, size);
+        size_t consumed = session->Process(pending.data(), pending.size(), output);
+        pending.consume(consumed);
+        pending.release();
+    }
+}
+
+// See Connection.h
+bool Connection::PrepareSend() {
+    if (sending.empty()) {
+        if (output.empty()) {
+            return false;
+        }
+        std::swap(sending, output);
+    }
+
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = message_iov;
+    message.msg_iovlen = sending.prepare(message_iov, MessageSize);
+    return true;
+}
+
+// See Connection.h
+void Connection::OnSent(size_t size) { sending.consume(size); }
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
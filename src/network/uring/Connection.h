@@ -0,0 +1,111 @@
+#ifndef AFINA_NETWORK_URING_CONNECTION_H
+#define AFINA_NETWORK_URING_CONNECTION_H
+
+#include <memory>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <afina/execute/Output.h>
+
+#include "network/Input.h"
+#include "protocol/Session.h"
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace Uring {
+
+/**
+ * # Client connection
+ * Connection doesn't do IO by itself: worker receives data into the provided buffers, passes it to the connection
+ * and sends responses connection has got. Bytes being sent must stay in place until kernel is done with them, so
+ * responses produced meanwhile go into the separate output
+ */
+class Connection {
+public:
+    /**
+     * Connection speaks protocol of the given session, if there is no one then protocol is detected by the first
+     * byte client sends
+     */
+    Connection(int s, std::shared_ptr<Afina::Storage> ps, std::unique_ptr<Protocol::Session> pss = nullptr)
+        : _socket(s), pStorage(ps), session(std::move(pss)), receiving(false), sending_inflight(false),
+          closing(false), failed(false), queued(false) {}
+    ~Connection() { Close(); }
+
+    /**
+     * Prepare closed connection to serve the new client, as if it was just constructed by the same arguments.
+     * Session of the previous client is reused, buffers are borrowed from the thread pools only while in use
+     */
+    void Reset(int s, std::shared_ptr<Afina::Storage> ps, std::unique_ptr<Protocol::Session> pss = nullptr);
+
+    /**
+     * Close the socket
+     */
+    void Close();
+
+    /**
+     * Process bytes received, responses are appended to the output. Throws std::runtime_error if client violates
+     * protocol or sends request which is too large
+     */
+    void OnData(const char *data, size_t size);
+
+    /**
+     * Fills message by responses to be sent, if nothing is being sent already. Returns false if there is nothing
+     * to send
+     */
+    bool PrepareSend();
+
+    /**
+     * Account bytes of the message sent
+     */
+    void OnSent(size_t size);
+
+    /**
+     * Returns true if there are responses not sent yet
+     */
+    inline bool HasOutput() const { return !sending.empty() || !output.empty(); }
+
+private:
+    friend class Worker;
+
+    // Number of buffers single message could reference
+    static constexpr size_t MessageSize = 64;
+
+    int _socket;
+    std::shared_ptr<Afina::Storage> pStorage;
+    std::unique_ptr<Protocol::Session> session;
+
+    // Session of the previous client, reused once protocol is detected
+    std::unique_ptr<Protocol::Session> spare_session;
+
+    // Bytes received but not consumed by the session yet
+    Input pending;
+
+    // Responses not passed to the kernel yet and the ones being sent now, along with the message describing them
+    Execute::Output output;
+    Execute::Output sending;
+    struct msghdr message;
+    struct iovec message_iov[MessageSize];
+
+    // Operations kernel runs on behalf of the connection, it is deleted only once there are none of them
+    bool receiving;
+    bool sending_inflight;
+
+    // Client is gone, nothing is received anymore. If connection has failed then nothing is sent either
+    bool closing;
+    bool failed;
+
+    // Connection waits in the worker list of connections to send responses of
+    bool queued;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_CONNECTION_H
@@ -0,0 +1,172 @@
+#include "Ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// There is no libc wrappers for io_uring
+int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+} // namespace
+
+// See Ring.h
+Ring::Ring(unsigned entries)
+    : _sq_ring(MAP_FAILED), _sq_ring_size(0), _cq_ring(MAP_FAILED), _cq_ring_size(0), _sqes(nullptr), _sqes_size(0) {
+    // Kernel runs completion work once we enter the ring instead of interrupting the worker, fall back to the
+    // default mode if kernel doesn't know the flag
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    _fd = io_uring_setup(entries, &params);
+    if (_fd == -1 && errno == EINVAL) {
+        std::memset(&params, 0, sizeof(params));
+        _fd = io_uring_setup(entries, &params);
+    }
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to setup io_uring: " + std::string(strerror(errno)));
+    }
+
+    if (!(params.features & IORING_FEAT_NODROP)) {
+        close(_fd);
+        throw std::runtime_error("Kernel io_uring is too old");
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if (single_mmap) {
+        _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+    }
+
+    _sq_ring =
+        mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+    if (_sq_ring != MAP_FAILED) {
+        _cq_ring = single_mmap ? _sq_ring
+                               : mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      _fd, IORING_OFF_CQ_RING);
+    }
+
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = MAP_FAILED;
+    if (_cq_ring != MAP_FAILED) {
+        sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+    }
+    if (sqes == MAP_FAILED) {
+        std::string error = strerror(errno);
+        release();
+        throw std::runtime_error("Failed to map io_uring: " + error);
+    }
+    _sqes = static_cast<struct io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(_sq_ring);
+    _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+    _sq_local_tail = *_sq_tail;
+
+    // Entries are always taken in order, so the indirection array is identity
+    for (unsigned i = 0; i < _sq_entries; i++) {
+        _sq_array[i] = i;
+    }
+
+    char *cq = static_cast<char *>(_cq_ring);
+    _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+}
+
+// See Ring.h
+Ring::~Ring() { release(); }
+
+// See Ring.h
+void Ring::release() {
+    if (_sqes != nullptr) {
+        munmap(_sqes, _sqes_size);
+    }
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    if (_sq_ring != MAP_FAILED) {
+        munmap(_sq_ring, _sq_ring_size);
+    }
+    close(_fd);
+}
+
+// See Ring.h
+struct io_uring_sqe *Ring::Next() {
+    if (_sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+        Submit(0);
+        if (_sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) == _sq_entries) {
+            throw std::runtime_error("io_uring submission queue overflow");
+        }
+    }
+
+    struct io_uring_sqe *sqe = &_sqes[_sq_local_tail & _sq_mask];
+    _sq_local_tail++;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// See Ring.h
+void Ring::Submit(unsigned wait_nr) {
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    if (to_submit == 0 && wait_nr == 0) {
+        return;
+    }
+
+    // Single syscall submits everything queued since the last time and waits for completions
+    if (io_uring_enter(_fd, to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0) == -1) {
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            throw std::runtime_error("Failed to enter io_uring: " + std::string(strerror(errno)));
+        }
+    }
+}
+
+// See Ring.h
+BufferGroup::BufferGroup(Ring &ring, uint16_t group, uint16_t count, size_t size, uint64_t user_data)
+    : _ring(ring), _group(group), _size(size), _user_data(user_data), _buffers(new char[size_t(count) * size]) {
+    provide(0, count);
+}
+
+// See Ring.h
+BufferGroup::~BufferGroup() { delete[] _buffers; }
+
+// See Ring.h
+void BufferGroup::provide(uint16_t id, uint16_t count) {
+    struct io_uring_sqe *sqe = _ring.Next();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->fd = count;
+    sqe->addr = reinterpret_cast<uint64_t>(Buffer(id));
+    sqe->len = _size;
+    sqe->off = id;
+    sqe->buf_group = _group;
+    sqe->user_data = _user_data;
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,130 @@
+#ifndef AFINA_NETWORK_URING_RING_H
+#define AFINA_NETWORK_URING_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+/**
+ * # io_uring instance
+ * Thin wrapper over raw io_uring syscalls: submission queue entries are filled by the caller, submitted all at once
+ * along with the wait for completions, and completions are reaped in batch. Ring isn't thread safe, it's meant to
+ * be owned by a single thread
+ */
+class Ring {
+public:
+    /**
+     * Creates ring with the given number of submission entries. Throws std::runtime_error if kernel doesn't
+     * support io_uring or features server relies on
+     */
+    Ring(unsigned entries);
+    ~Ring();
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    inline int fd() const { return _fd; }
+
+    /**
+     * Returns zeroed submission entry to be filled. If submission queue is full already queued entries are
+     * submitted first
+     */
+    struct io_uring_sqe *Next();
+
+    /**
+     * Submits queued entries and waits for at least wait_nr completions, interrupted wait returns earlier
+     */
+    void Submit(unsigned wait_nr);
+
+    /**
+     * Calls f for every available completion, the completion is released once f returns
+     */
+    template <typename F> void Reap(F f) {
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            f(_cqes[head & _cq_mask]);
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    // Unmap rings and close the instance
+    void release();
+
+    int _fd;
+
+    // Mapped rings, sizes are kept to unmap
+    void *_sq_ring;
+    size_t _sq_ring_size;
+    void *_cq_ring;
+    size_t _cq_ring_size;
+    struct io_uring_sqe *_sqes;
+    size_t _sqes_size;
+
+    // Submission queue, entries are filled after the local tail and published on submit
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned *_sq_array;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+    unsigned _sq_local_tail;
+
+    // Completion queue
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    struct io_uring_cqe *_cqes;
+    unsigned _cq_mask;
+};
+
+/**
+ * # Group of provided buffers
+ * Buffers kernel picks from to place received data, so that memory is taken only once data arrives rather than
+ * being reserved by every connection waiting for it. Buffers are handed over to the kernel by submissions, buffer is
+ * given back by Recycle once its data is consumed
+ */
+class BufferGroup {
+public:
+    /**
+     * Allocates count buffers of the given size and provides them to the ring as a group. Successful provides don't
+     * complete, failed ones complete with the given user data
+     */
+    BufferGroup(Ring &ring, uint16_t group, uint16_t count, size_t size, uint64_t user_data);
+    ~BufferGroup();
+
+    BufferGroup(const BufferGroup &) = delete;
+    BufferGroup &operator=(const BufferGroup &) = delete;
+
+    inline uint16_t group() const { return _group; }
+
+    /**
+     * Returns buffer kernel placed data into, given by the completion flags
+     */
+    inline char *Buffer(uint16_t id) const { return _buffers + size_t(id) * _size; }
+
+    /**
+     * Gives buffer back to the kernel by the next submission
+     */
+    inline void Recycle(uint16_t id) { provide(id, 1); }
+
+private:
+    // Queue provide of count buffers starting with the given one
+    void provide(uint16_t id, uint16_t count);
+
+    Ring &_ring;
+    uint16_t _group;
+    size_t _size;
+    uint64_t _user_data;
+    char *_buffers;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_RING_H
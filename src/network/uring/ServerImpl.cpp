@@ -0,0 +1,145 @@
+#include "ServerImpl.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _resp_port(0), _event_fd(-1) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start io_uring network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    // Every worker accepts on its own sockets, kernel spreads connections between them. There are no acceptors
+    if (_resp_port != 0) {
+        _logger->info("Listen for RESP clients on {}", _resp_port);
+    }
+    _workers.reserve(n_workers);
+    for (int i = 0; i < n_workers; i++) {
+        int server_socket = Listen(port);
+        _worker_sockets.push_back(server_socket);
+
+        int resp_socket = -1;
+        if (_resp_port != 0) {
+            resp_socket = Listen(_resp_port);
+            _worker_sockets.push_back(resp_socket);
+        }
+
+        _workers.emplace_back(new Worker(pStorage, pLogging));
+        _workers.back()->Start(_event_fd, server_socket, resp_socket);
+    }
+}
+
+// See Server.h
+void ServerImpl::ListenResp(uint16_t port) { _resp_port = port; }
+
+// See Server.h
+void ServerImpl::ReusePort() {
+    // Workers always listen on their own SO_REUSEPORT sockets
+}
+
+// See ServerImpl.h
+int ServerImpl::Listen(uint16_t port) {
+    // Create server socket
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    int server_socket = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (setsockopt(server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(server_socket, listen_backlog) == -1) {
+        close(server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    return server_socket;
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    // Said workers to stop
+    for (auto &w : _workers) {
+        w->Stop();
+    }
+
+    // Wakeup threads that are waiting for completions
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup workers");
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &w : _workers) {
+        w->Join();
+    }
+    for (int socket : _worker_sockets) {
+        close(socket);
+    }
+    close(_event_fd);
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,71 @@
+#ifndef AFINA_NETWORK_URING_SERVER_H
+#define AFINA_NETWORK_URING_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Network resource manager implementation
+ * io_uring based server: every worker runs own ring and accepts connections on its own SO_REUSEPORT sockets, so
+ * there are no acceptor threads
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void ListenResp(uint16_t port) override;
+
+    // See Server.h
+    void ReusePort() override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+protected:
+    // Opens blocking socket listening on the given port with SO_REUSEPORT. Ring would fail accept on non-blocking
+    // socket instead of waiting for connections
+    int Listen(uint16_t port);
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Port to accept Redis protocol clients on, 0 if they aren't served
+    uint16_t _resp_port;
+
+    // Sockets workers accept connections on
+    std::vector<int> _worker_sockets;
+
+    // Custom event "device" used to wakeup workers
+    int _event_fd;
+
+    // Threads serving connections, each has private ring
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_URING_SERVER_H
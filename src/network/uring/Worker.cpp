@@ -0,0 +1,283 @@
+#include "Worker.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/logging/Service.h>
+
+#include "Connection.h"
+#include "Ring.h"
+#include "protocol/RespSession.h"
+
+namespace Afina {
+namespace Network {
+namespace Uring {
+
+namespace {
+
+// Submission queue size, completion queue is twice as large
+constexpr unsigned RingEntries = 1024;
+
+// Buffers received data is placed into, shared by all connections of the worker
+constexpr uint16_t BufferCount = 1024;
+constexpr size_t BufferSize = 4096;
+
+// Operation completion belongs to is kept in the low bits of the user data, pointers are aligned enough. Control
+// operations are the ones worker runs for itself: eventfd poll and provide of buffers, which completes on failure only
+enum Operation : uint64_t { OpControl = 0, OpAccept = 1, OpReceive = 2, OpSend = 3 };
+constexpr uint64_t OperationMask = 3;
+
+inline uint64_t Tag(void *ptr, Operation op) { return reinterpret_cast<uint64_t>(ptr) | op; }
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl)
+    : _pStorage(ps), _pLogging(pl), isRunning(false), _server_sockets{-1, -1}, _event_fd(-1) {}
+
+// See Worker.h
+Worker::~Worker() {}
+
+// See Worker.h
+void Worker::Start(int event_fd, int server_socket, int resp_socket) {
+    if (isRunning.exchange(true) == false) {
+        assert(!_ring);
+        _ring.reset(new Ring(RingEntries));
+        _buffers.reset(new BufferGroup(*_ring, 0, BufferCount, BufferSize, Tag(&_buffers, OpControl)));
+
+        // Eventfd is never read, so that single poll wakes worker up once server signals it
+        _event_fd = event_fd;
+        struct io_uring_sqe *sqe = _ring->Next();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = _event_fd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = Tag(nullptr, OpControl);
+
+        _server_sockets[0] = server_socket;
+        _server_sockets[1] = resp_socket;
+        for (int &socket : _server_sockets) {
+            if (socket != -1) {
+                Accept(&socket);
+            }
+        }
+
+        _logger = _pLogging->select("network.worker");
+        _thread = std::thread(&Worker::OnRun, this);
+    }
+}
+
+// See Worker.h
+void Worker::Stop() { isRunning = false; }
+
+// See Worker.h
+void Worker::Join() {
+    assert(_thread.joinable());
+    _thread.join();
+    _ring.reset();
+    _buffers.reset();
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    _logger->trace("OnRun");
+
+    auto on_completion = [this](const struct io_uring_cqe &cqe) { OnCompletion(cqe); };
+    auto flush = [this]() {
+        // Responses to everything received in the batch go out with the next submission
+        for (Connection *pc : _ready) {
+            pc->queued = false;
+            Send(pc);
+            Release(pc);
+        }
+        _ready.clear();
+    };
+
+    while (isRunning) {
+        _ring->Submit(1);
+        _ring->Reap(on_completion);
+        flush();
+    }
+
+    // Connections are closed, but they are released only once kernel completes everything started on their behalf,
+    // since it references memory of the connections
+    std::vector<Connection *> connections(_connections.begin(), _connections.end());
+    for (Connection *pc : connections) {
+        Fail(pc);
+        Release(pc);
+    }
+    while (!_connections.empty()) {
+        _ring->Submit(1);
+        _ring->Reap(on_completion);
+        flush();
+    }
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::OnCompletion(const struct io_uring_cqe &cqe) {
+    void *ptr = reinterpret_cast<void *>(cqe.user_data & ~OperationMask);
+    switch (cqe.user_data & OperationMask) {
+    case OpControl:
+        if (ptr == &_buffers) {
+            _logger->error("Failed to provide buffers: {}", strerror(-cqe.res));
+        } else {
+            // Server signals us to process some state change, react on it in the outer loop
+            _logger->debug("Worker wokeup");
+        }
+        break;
+
+    case OpAccept: {
+        int *server_socket = static_cast<int *>(ptr);
+        if (cqe.res >= 0 && !isRunning) {
+            close(cqe.res);
+        } else if (cqe.res >= 0) {
+            std::unique_ptr<Protocol::Session> session;
+            if (server_socket == &_server_sockets[1]) {
+                session.reset(new Protocol::RespSession(_pStorage));
+            }
+
+            Connection *pc = _pool.Get(cqe.res, _pStorage, std::move(session));
+            _connections.insert(pc);
+            Receive(pc);
+        } else {
+            _logger->error("Failed to accept connection: {}", strerror(-cqe.res));
+        }
+
+        // Multishot accept could be terminated by kernel
+        if (!(cqe.flags & IORING_CQE_F_MORE) && isRunning) {
+            Accept(server_socket);
+        }
+        break;
+    }
+
+    case OpReceive: {
+        Connection *pc = static_cast<Connection *>(ptr);
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            uint16_t id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+            if (cqe.res > 0 && !pc->closing) {
+                try {
+                    pc->OnData(_buffers->Buffer(id), cqe.res);
+                } catch (std::runtime_error &ex) {
+                    _logger->error("Failed to process connection on descriptor {}: {}", pc->_socket, ex.what());
+                    Fail(pc);
+                }
+            }
+            _buffers->Recycle(id);
+
+            if (pc->HasOutput()) {
+                Ready(pc);
+            }
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            pc->receiving = false;
+            if ((cqe.res > 0 || cqe.res == -ENOBUFS) && !pc->closing) {
+                // Multishot receive is over, for example worker has run out of buffers. They are given back
+                // while completions are processed, so just start over
+                Receive(pc);
+            } else if (cqe.res < 0) {
+                _logger->debug("Failed to receive on descriptor {}: {}", pc->_socket, strerror(-cqe.res));
+                Fail(pc);
+            } else {
+                // Client is gone, send what is left
+                pc->closing = true;
+            }
+        }
+        Release(pc);
+        break;
+    }
+
+    case OpSend: {
+        Connection *pc = static_cast<Connection *>(ptr);
+        pc->sending_inflight = false;
+        if (cqe.res < 0) {
+            _logger->debug("Failed to send on descriptor {}: {}", pc->_socket, strerror(-cqe.res));
+            Fail(pc);
+        } else {
+            pc->OnSent(cqe.res);
+            if (pc->HasOutput()) {
+                Ready(pc);
+            }
+        }
+        Release(pc);
+        break;
+    }
+    }
+}
+
+// See Worker.h
+void Worker::Accept(int *server_socket) {
+    struct io_uring_sqe *sqe = _ring->Next();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = *server_socket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = Tag(server_socket, OpAccept);
+}
+
+// See Worker.h
+void Worker::Receive(Connection *pc) {
+    struct io_uring_sqe *sqe = _ring->Next();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = pc->_socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = _buffers->group();
+    sqe->user_data = Tag(pc, OpReceive);
+    pc->receiving = true;
+}
+
+// See Worker.h
+void Worker::Send(Connection *pc) {
+    // Single send at a time: kernel could send less than asked, the rest goes after it
+    if (pc->failed || pc->sending_inflight || !pc->PrepareSend()) {
+        return;
+    }
+
+    struct io_uring_sqe *sqe = _ring->Next();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = pc->_socket;
+    sqe->addr = reinterpret_cast<uint64_t>(&pc->message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = Tag(pc, OpSend);
+    pc->sending_inflight = true;
+}
+
+// See Worker.h
+void Worker::Ready(Connection *pc) {
+    if (!pc->queued && !pc->failed) {
+        pc->queued = true;
+        _ready.push_back(pc);
+    }
+}
+
+// See Worker.h
+void Worker::Fail(Connection *pc) {
+    // Shutdown completes everything pending on the socket
+    if (!pc->failed) {
+        pc->closing = pc->failed = true;
+        shutdown(pc->_socket, SHUT_RDWR);
+    }
+}
+
+// See Worker.h
+void Worker::Release(Connection *pc) {
+    if (pc->closing && !pc->receiving && !pc->sending_inflight && !pc->queued && (pc->failed || !pc->HasOutput())) {
+        _connections.erase(pc);
+        pc->Close();
+        _pool.Put(pc);
+    }
+}
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
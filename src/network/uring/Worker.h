@@ -0,0 +1,130 @@
+#ifndef AFINA_NETWORK_URING_WORKER_H
+#define AFINA_NETWORK_URING_WORKER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "network/Pool.h"
+
+namespace spdlog {
+class logger;
+}
+
+struct io_uring_cqe;
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+namespace Logging {
+class Service;
+}
+
+namespace Network {
+namespace Uring {
+
+// Forward declarations, see Connection.h and Ring.h
+class Connection;
+class Ring;
+class BufferGroup;
+
+/**
+ * # Thread running io_uring
+ * On Start spawns background thread serving connections it accepts on its own server sockets. Everything is done by
+ * the kernel on behalf of the ring: accept and receive are multishot, so that they are submitted once and keep
+ * completing, received data lands into the buffers provided by the worker. Responses to everything received in a
+ * batch of completions are sent by the same submission, which also waits for the next batch
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl);
+    ~Worker();
+
+    /**
+     * Creates ring of the worker and spawns new background thread that serves it. Worker accepts connections on
+     * the given server socket, RESP clients on resp_socket if there is one. Besides them worker watches given
+     * eventfd, server signals it to wake workers up
+     */
+    void Start(int event_fd, int server_socket, int resp_socket = -1);
+
+    /**
+     * Signal background thread to stop. Thread stops to accept new connections, closes ones it serves and waits
+     * until kernel is done with every operation on their behalf
+     */
+    void Stop();
+
+    /**
+     * Blocks calling thread until background one for this worker is actually been destroyed
+     */
+    void Join();
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+    /**
+     * Dispatches single completion to the operation it belongs to
+     */
+    void OnCompletion(const struct io_uring_cqe &cqe);
+
+    // Queue operations on behalf of the worker
+    void Accept(int *server_socket);
+    void Receive(Connection *pc);
+    void Send(Connection *pc);
+
+    // Remember connection has responses to send, they are sent once the current batch of completions is processed
+    void Ready(Connection *pc);
+
+    // Stop serving connection because of error, nothing is received and sent anymore
+    void Fail(Connection *pc);
+
+    // Closes connection and keeps it for reuse once kernel has no operations on its behalf
+    void Release(Connection *pc);
+
+private:
+    Worker(Worker &) = delete;
+    Worker &operator=(Worker &) = delete;
+
+    // afina services
+    std::shared_ptr<Afina::Storage> _pStorage;
+
+    // afina services
+    std::shared_ptr<Afina::Logging::Service> _pLogging;
+
+    // Logger to be used
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Flag signals that thread should continue to operate
+    std::atomic<bool> isRunning;
+
+    // Thread serving requests in this worker
+    std::thread _thread;
+
+    // Ring along with buffers received data is placed into, owned by the worker
+    std::unique_ptr<Ring> _ring;
+    std::unique_ptr<BufferGroup> _buffers;
+
+    // Sockets worker accepts connections on, memcached and RESP ones, -1 if there is no one. Accept completions
+    // point to the array items
+    int _server_sockets[2];
+
+    // Eventfd server wakes workers up with
+    int _event_fd;
+
+    // Connections served by the worker and the ones having responses to send
+    std::unordered_set<Connection *> _connections;
+    std::vector<Connection *> _ready;
+
+    // Closed connections, reused for the new clients
+    Pool<Connection> _pool;
+};
+
+} // namespace Uring
+} // namespace Network
+} // namespace Afina
+#endif // AFINA_NETWORK_URING_WORKER_H
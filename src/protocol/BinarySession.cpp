@@ -0,0 +1,317 @@
+#include "BinarySession.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Protocol {
+
+constexpr uint8_t BinarySession::RequestMagic;
+constexpr uint8_t BinarySession::ResponseMagic;
+constexpr size_t BinarySession::HeaderSize;
+constexpr size_t BinarySession::MaxBodySize;
+
+namespace {
+
+inline uint16_t read16(const char *p) {
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(p);
+    return (uint16_t(b[0]) << 8) | b[1];
+}
+
+inline uint32_t read32(const char *p) {
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(p);
+    return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+}
+
+inline void write16(Execute::Output &out, uint16_t v) {
+    out.push_back(char(v >> 8));
+    out.push_back(char(v));
+}
+
+inline void write32(Execute::Output &out, uint32_t v) {
+    out.push_back(char(v >> 24));
+    out.push_back(char(v >> 16));
+    out.push_back(char(v >> 8));
+    out.push_back(char(v));
+}
+
+// Header fields
+inline uint8_t opcode(const char *packet) { return uint8_t(packet[1]); }
+inline uint16_t key_length(const char *packet) { return read16(packet + 2); }
+inline uint8_t extras_length(const char *packet) { return uint8_t(packet[4]); }
+inline uint32_t body_length(const char *packet) { return read32(packet + 8); }
+
+// Throws if header isn't a header of the binary protocol request. Returns false if body is too large to be
+// collected, such request has to be refused
+bool check_header(const char *packet) {
+    if (uint8_t(packet[0]) != BinarySession::RequestMagic) {
+        std::stringstream err;
+        err << "Invalid magic " << int(uint8_t(packet[0])) << ", binary protocol request expected";
+        throw std::runtime_error(err.str());
+    }
+    return body_length(packet) <= BinarySession::MaxBodySize;
+}
+
+// Flags of the value, storage doesn't keep them so they are always zero
+const char zero_flags[4] = {0, 0, 0, 0};
+
+} // namespace
+
+// See BinarySession.h
+size_t BinarySession::Process(const char *input, size_t size, Execute::Output &out) {
+    size_t begin = 0;
+    while (begin < size) {
+        // Drop body of the refused request
+        if (_skip > 0) {
+            size_t to_skip = std::min(_skip, size - begin);
+            _skip -= to_skip;
+            begin += to_skip;
+            continue;
+        }
+
+        // Continue packet started in the one of previous calls
+        if (!_pending.empty()) {
+            size_t need = HeaderSize;
+            if (_pending.size() >= HeaderSize) {
+                need += body_length(_pending.data());
+            }
+
+            size_t to_read = std::min(need - _pending.size(), size - begin);
+            _pending.append(input + begin, to_read);
+            begin += to_read;
+
+            if (_pending.size() == HeaderSize && !check_header(_pending.data())) {
+                Error(out, _pending.data(), stValueTooLarge);
+                _skip = body_length(_pending.data());
+                _pending.clear();
+                continue;
+            }
+            if (_pending.size() >= HeaderSize && _pending.size() == HeaderSize + body_length(_pending.data())) {
+                Execute(_pending.data(), out);
+                _pending.clear();
+            }
+            continue;
+        }
+
+        // Whole packet is in the input, run it in place
+        const char *packet = input + begin;
+        size_t available = size - begin;
+        if (available >= HeaderSize) {
+            if (!check_header(packet)) {
+                Error(out, packet, stValueTooLarge);
+                _skip = body_length(packet);
+                begin += HeaderSize;
+                continue;
+            }
+
+            size_t total = HeaderSize + body_length(packet);
+            if (available >= total) {
+                Execute(packet, out);
+                begin += total;
+                continue;
+            }
+        }
+
+        // Packet is splitted, keep what we have got and wait for the rest
+        _pending.assign(packet, available);
+        begin = size;
+    }
+
+    return begin;
+}
+
+// See BinarySession.h
+void BinarySession::Reset() {
+    _pending.clear();
+    _skip = 0;
+}
+
+// See BinarySession.h
+void BinarySession::Execute(const char *packet, Execute::Output &out) {
+    uint8_t op = opcode(packet);
+    size_t extras_size = extras_length(packet);
+    size_t key_size = key_length(packet);
+    size_t body_size = body_length(packet);
+    if (extras_size + key_size > body_size) {
+        Error(out, packet, stInvalidArguments);
+        return;
+    }
+
+    const char *body = packet + HeaderSize;
+    StringRef key(body + extras_size, key_size);
+    StringRef value(body + extras_size + key_size, body_size - extras_size - key_size);
+
+    switch (op) {
+    case opGet:
+    case opGetQ:
+    case opGetK:
+    case opGetKQ: {
+        if (extras_size != 0 || key.empty() || !value.empty()) {
+            Error(out, packet, stInvalidArguments);
+            return;
+        }
+
+        bool with_key = (op == opGetK || op == opGetKQ);
+        bool quiet = (op == opGetQ || op == opGetKQ);
+
+        // Value is shared with the storage, not copied
+        std::shared_ptr<const std::string> result;
+        if (pStorage->Get(key, result)) {
+            Respond(out, packet, stOk, StringRef(zero_flags, sizeof(zero_flags)), with_key ? key : StringRef(),
+                    std::move(result));
+        } else if (!quiet) {
+            Respond(out, packet, stKeyNotFound, StringRef(), with_key ? key : StringRef(), "Not found");
+        }
+        return;
+    }
+
+    case opSet:
+    case opSetQ:
+    case opAdd:
+    case opAddQ:
+    case opReplace:
+    case opReplaceQ: {
+        // Extras are flags and expiration time, 4 bytes each
+        if (extras_size != 8 || key.empty()) {
+            Error(out, packet, stInvalidArguments);
+            return;
+        }
+
+        uint16_t status = stOk;
+        if (op == opSet || op == opSetQ) {
+            status = pStorage->Put(key, value.str()) ? stOk : stNotStored;
+        } else if (op == opAdd || op == opAddQ) {
+            status = pStorage->PutIfAbsent(key, value.str()) ? stOk : stKeyExists;
+        } else {
+            status = pStorage->Set(key, value.str()) ? stOk : stKeyNotFound;
+        }
+
+        if (status != stOk) {
+            Error(out, packet, status);
+        } else if (op == opSet || op == opAdd || op == opReplace) {
+            Respond(out, packet, stOk, StringRef(), StringRef(), StringRef());
+        }
+        return;
+    }
+
+    case opAppend:
+    case opAppendQ:
+    case opPrepend:
+    case opPrependQ: {
+        if (extras_size != 0 || key.empty()) {
+            Error(out, packet, stInvalidArguments);
+            return;
+        }
+
+        // Read and write go in one batch, so concurrent appends to the same key aren't lost in between
+        bool stored = false;
+        pStorage->Batch([op, key, value, &stored](Storage &storage) {
+            std::string result;
+            if (!storage.Get(key, result)) {
+                return;
+            }
+
+            if (op == opAppend || op == opAppendQ) {
+                result.append(value.data(), value.size());
+            } else {
+                result.insert(0, value.data(), value.size());
+            }
+            stored = storage.Put(key, std::move(result));
+        });
+
+        if (!stored) {
+            Error(out, packet, stNotStored);
+        } else if (op == opAppend || op == opPrepend) {
+            Respond(out, packet, stOk, StringRef(), StringRef(), StringRef());
+        }
+        return;
+    }
+
+    case opDelete:
+    case opDeleteQ: {
+        if (extras_size != 0 || key.empty() || !value.empty()) {
+            Error(out, packet, stInvalidArguments);
+            return;
+        }
+
+        if (!pStorage->Delete(key)) {
+            Error(out, packet, stKeyNotFound);
+        } else if (op == opDelete) {
+            Respond(out, packet, stOk, StringRef(), StringRef(), StringRef());
+        }
+        return;
+    }
+
+    case opNoop:
+        Respond(out, packet, stOk, StringRef(), StringRef(), StringRef());
+        return;
+
+    default:
+        Error(out, packet, stUnknownCommand);
+        return;
+    }
+}
+
+// See BinarySession.h
+void BinarySession::Respond(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                            StringRef value) {
+    Header(out, request, status, extras, key, value.size());
+    out.append(value.data(), value.size());
+}
+
+// See BinarySession.h
+void BinarySession::Respond(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                            std::shared_ptr<const std::string> value) {
+    size_t value_size = value->size();
+    Header(out, request, status, extras, key, value_size);
+    out.append(std::move(value));
+}
+
+// See BinarySession.h
+void BinarySession::Header(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                           size_t value_size) {
+    out.push_back(char(ResponseMagic));
+    out.push_back(char(opcode(request)));
+    write16(out, uint16_t(key.size()));
+    out.push_back(char(extras.size()));
+    out.push_back(0); // data type
+    write16(out, status);
+    write32(out, uint32_t(extras.size() + key.size() + value_size));
+    out.append(request + 12, 4); // opaque
+    out.append(8, '\0');         // CAS
+
+    out.append(extras.data(), extras.size());
+    out.append(key.data(), key.size());
+}
+
+// See BinarySession.h
+void BinarySession::Error(Execute::Output &out, const char *request, uint16_t status) {
+    const char *message = "Unknown error";
+    switch (status) {
+    case stKeyNotFound:
+        message = "Not found";
+        break;
+    case stKeyExists:
+        message = "Data exists for key";
+        break;
+    case stValueTooLarge:
+        message = "Too large";
+        break;
+    case stInvalidArguments:
+        message = "Invalid arguments";
+        break;
+    case stNotStored:
+        message = "Not stored";
+        break;
+    case stUnknownCommand:
+        message = "Unknown command";
+        break;
+    }
+    Respond(out, request, status, StringRef(), StringRef(), message);
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,120 @@
+#ifndef AFINA_PROTOCOL_BINARY_SESSION_H
+#define AFINA_PROTOCOL_BINARY_SESSION_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <afina/StringRef.h>
+
+#include "Session.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Memcached binary protocol session
+ * Every packet starts with fixed 24 bytes header, all integers there are in network byte order:
+ *
+ *  Byte/     0       |       1       |       2       |       3       |
+ *     +---------------+---------------+---------------+---------------+
+ *    0| Magic         | Opcode        | Key length                    |
+ *     +---------------+---------------+---------------+---------------+
+ *    4| Extras length | Data type     | vbucket id / Status           |
+ *     +---------------+---------------+---------------+---------------+
+ *    8| Total body length                                             |
+ *     +---------------+---------------+---------------+---------------+
+ *   12| Opaque                                                        |
+ *     +---------------+---------------+---------------+---------------+
+ *   16| CAS                                                           |
+ *     |                                                               |
+ *     +---------------+---------------+---------------+---------------+
+ *
+ * Body follows the header and consists of extras, key and value, in that order. Lengths of all three are known
+ * from the header, so there is nothing to parse: request is executed as soon as whole packet arrived. Opaque is
+ * copied into the response as is, so client could match responses to requests.
+ *
+ * Quiet versions of commands don't respond on success, GETQ and GETKQ don't respond on miss, that allows clients
+ * to pipeline multi-get as a chain of GETKQ finished by NOOP.
+ *
+ * Packet is collected in full before execution, so body longer than MaxBodySize is refused right after the header
+ * and skipped as it arrives instead of being buffered.
+ */
+class BinarySession : public Session {
+public:
+    static constexpr uint8_t RequestMagic = 0x80;
+    static constexpr uint8_t ResponseMagic = 0x81;
+    static constexpr size_t HeaderSize = 24;
+
+    // Memcached default limit of the item size, protects from buffering whatever client announces
+    static constexpr size_t MaxBodySize = 1024 * 1024;
+
+    enum Opcode : uint8_t {
+        opGet = 0x00,
+        opSet = 0x01,
+        opAdd = 0x02,
+        opReplace = 0x03,
+        opDelete = 0x04,
+        opGetQ = 0x09,
+        opNoop = 0x0a,
+        opGetK = 0x0c,
+        opGetKQ = 0x0d,
+        opAppend = 0x0e,
+        opPrepend = 0x0f,
+        opSetQ = 0x11,
+        opAddQ = 0x12,
+        opReplaceQ = 0x13,
+        opDeleteQ = 0x14,
+        opAppendQ = 0x19,
+        opPrependQ = 0x1a
+    };
+
+    enum Status : uint16_t {
+        stOk = 0x0000,
+        stKeyNotFound = 0x0001,
+        stKeyExists = 0x0002,
+        stValueTooLarge = 0x0003,
+        stInvalidArguments = 0x0004,
+        stNotStored = 0x0005,
+        stUnknownCommand = 0x0081
+    };
+
+    BinarySession(std::shared_ptr<Afina::Storage> storage) : Session(storage), _skip(0) {}
+    ~BinarySession() {}
+
+    // See Session.h
+    size_t Process(const char *input, size_t size, Execute::Output &out) override;
+
+    // See Session.h
+    void Reset() override;
+
+private:
+    // Executes single request, packet points to the header followed by the whole body
+    void Execute(const char *packet, Execute::Output &out);
+
+    // Appends response packet to the out
+    static void Respond(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                        StringRef value);
+
+    // Same as above, but value shared with the storage is referenced by the out instead of being copied
+    static void Respond(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                        std::shared_ptr<const std::string> value);
+
+    // Appends response header followed by extras and key, value of the given size has to follow
+    static void Header(Execute::Output &out, const char *request, uint16_t status, StringRef extras, StringRef key,
+                       size_t value_size);
+
+    // Appends error response packet with textual description as a value
+    static void Error(Execute::Output &out, const char *request, uint16_t status);
+
+    // Packet splitted between Process calls, collected so far
+    std::string _pending;
+
+    // Bytes of the refused body yet to be dropped
+    size_t _skip;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_SESSION_H
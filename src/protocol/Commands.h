@@ -0,0 +1,74 @@
+#ifndef AFINA_PROTOCOL_COMMANDS_H
+#define AFINA_PROTOCOL_COMMANDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Command names table
+ * Every command name known to the protocol gets hashed at compile time, so recognizing command in the input
+ * costs one hash over the name token, one switch and one memcmp to reject foreign names with the same hash.
+ * Compiler refuses duplicate case labels, so collision between two known names is a build error
+ */
+enum class CommandId : uint8_t {
+    Unknown,
+    Set,
+    Add,
+    Replace,
+    Append,
+    Prepend,
+    Get,
+    Gets,
+    Stats,
+    MetaGet,
+    MetaSet,
+    MetaDelete,
+    MetaNoop
+};
+
+/**
+ * FNV-1a, written recursively to be C++11 constexpr
+ */
+constexpr uint32_t HashName(const char *name, size_t size, uint32_t hash = 2166136261u) {
+    return size == 0 ? hash
+                     : HashName(name + 1, size - 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u);
+}
+
+template <size_t N> constexpr uint32_t HashName(const char (&name)[N]) { return HashName(name, N - 1); }
+
+/**
+ * Returns id of the command with the given name, or CommandId::Unknown
+ */
+inline CommandId LookupCommand(const char *name, size_t size) {
+#define AFINA_COMMAND_NAME(str, id)                                                                                \
+    case HashName(str):                                                                                            \
+        return (size == sizeof(str) - 1 && std::memcmp(name, str, size) == 0) ? CommandId::id : CommandId::Unknown;
+
+    switch (HashName(name, size)) {
+        AFINA_COMMAND_NAME("set", Set)
+        AFINA_COMMAND_NAME("add", Add)
+        AFINA_COMMAND_NAME("replace", Replace)
+        AFINA_COMMAND_NAME("append", Append)
+        AFINA_COMMAND_NAME("prepend", Prepend)
+        AFINA_COMMAND_NAME("get", Get)
+        AFINA_COMMAND_NAME("gets", Gets)
+        AFINA_COMMAND_NAME("stats", Stats)
+        AFINA_COMMAND_NAME("mg", MetaGet)
+        AFINA_COMMAND_NAME("ms", MetaSet)
+        AFINA_COMMAND_NAME("md", MetaDelete)
+        AFINA_COMMAND_NAME("mn", MetaNoop)
+    default:
+        return CommandId::Unknown;
+    }
+
+#undef AFINA_COMMAND_NAME
+}
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_COMMANDS_H
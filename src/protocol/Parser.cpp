@@ -1,92 +1,207 @@
 #include "Parser.h"
 
-#include <iostream>
-#include <sstream>
-#include <stdexcept>
-
-#include <afina/execute/Add.h>
-#include <afina/execute/Append.h>
-#include <afina/execute/Command.h>
-#include <afina/execute/Delete.h>
-#include <afina/execute/Get.h>
-#include <afina/execute/Set.h>
-#include <afina/execute/Stats.h>
+#include <cstring>
+
+#include <afina/execute/AnyCommand.h>
+
+#include "Scanner.h"
 
 namespace Afina {
 namespace Protocol {
 
+namespace {
+
+// Memcached limits key length, longer keys are rejected instead of being accumulated
+const size_t MaxKeySize = 250;
+
+// Limits for the rest of tokens, no valid command comes close to them
+const size_t MaxNameSize = 16;
+const size_t MaxMetaSize = 1024;
+
+// Responses to malformed commands
+const char ErrorUnknownCommand[] = "ERROR";
+const char ErrorBadFormat[] = "CLIENT_ERROR bad command line format";
+const char ErrorKeyTooLong[] = "CLIENT_ERROR key too long";
+const char ErrorNoKey[] = "CLIENT_ERROR no key";
+const char ErrorOverflow[] = "CLIENT_ERROR numeric field overflow";
+const char ErrorBadNoreply[] = "CLIENT_ERROR noreply expected";
+const char ErrorBadMetaFlags[] = "CLIENT_ERROR bad meta flags";
+const char ErrorNotSupported[] = "SERVER_ERROR command not supported";
+
+} // namespace
+
 // See Parse.h
 bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
-    size_t pos;
+    size_t pos = 0;
     parsed = 0;
 
-    for (pos = 0; pos < size && !parse_complete; pos++) {
+    while (pos < size && !parse_complete) {
         char c = input[pos];
-        // std::cout << "[" << pos << "] '" << c << "': state=" << int(state) << std::endl;
 
         switch (state) {
         case State::sName: {
-            if (c == ' ' || c == '\r') {
-                // std::cout << "parser debug: name='" << name << "'" << std::endl;
-                if (name == "set" || name == "add" || name == "append" || name == "prepend") {
-                    state = State::spKey;
-                } else if (name == "get" || name == "gets") {
-                    state = State::sgKey;
-                } else if (name == "stats") {
-                    state = State::sLF;
-                    continue;
-                } else {
-                    throw std::runtime_error("Unknown command name: " + name);
-                }
-            } else {
-                name.push_back(c);
+            // Whole token at once, it ends either by space or by \r
+            const char *stop = FindDelimiter(input + pos, input + size);
+            const char *lf = static_cast<const char *>(std::memchr(input + pos, '\n', stop - (input + pos)));
+            if (lf != nullptr) {
+                // Bare \n ends the line, so the next one doesn't depend on how input got splitted
+                pos = lf - input;
+                fail(ErrorUnknownCommand);
+                continue;
+            }
+
+            name.append(input + pos, stop);
+            pos = stop - input;
+            if (name.size() > MaxNameSize) {
+                fail(ErrorUnknownCommand);
+                continue;
+            } else if (pos == size) {
+                continue;
+            }
+
+            command = LookupCommand(name.data(), name.size());
+            switch (command) {
+            case CommandId::Set:
+            case CommandId::Add:
+            case CommandId::Replace:
+            case CommandId::Append:
+            case CommandId::Prepend:
+                state = State::spKey;
+                break;
+            case CommandId::Get:
+            case CommandId::Gets:
+                state = State::sgKey;
+                break;
+            case CommandId::Stats:
+            case CommandId::MetaNoop:
+                state = State::sLF;
+                break;
+            case CommandId::MetaGet:
+            case CommandId::MetaSet:
+            case CommandId::MetaDelete:
+                state = State::smKey;
+                break;
+            default:
+                fail(ErrorUnknownCommand);
+                continue;
+            }
+
+            // Line ends right after the name of the command which requires arguments
+            if (input[pos] == '\r' && state != State::sLF) {
+                fail(ErrorBadFormat);
+                continue;
             }
             break;
         }
 
         case State::spKey: {
-            if (c == ' ') {
-                state = State::spFlags;
-                keys.push_back(curKey);
-                // std::cout << "parser debug: key[" << keys.size() - 1 << "]='" << curKey << "'" << std::endl;
-            } else {
-                curKey.push_back(c);
+            // Only space finishes key of the storage command, \r is a part of it
+            const char *start = input + pos;
+            const char *stop = FindDelimiter(start, input + size);
+            while (stop < input + size && *stop != ' ') {
+                stop = FindDelimiter(stop + 1, input + size);
+            }
+            pos = stop - input;
+            if (pos == size) {
+                if (!splitKey(start, stop)) {
+                    pos = (start - input) + keyRoom();
+                    fail(ErrorKeyTooLong);
+                }
+                continue;
+            }
+
+            if (!endKey(start, stop)) {
+                pos = (start - input) + keyRoom();
+                fail(ErrorKeyTooLong);
+                continue;
             }
+            state = State::spFlags;
             break;
         }
 
         case State::sgKey: {
-            if (c == '\r') {
-                keys.push_back(curKey);
-                // std::cout << "parser debug: total '" << keys.size() << " keys" << std::endl;
+            const char *start = input + pos;
+            const char *stop = FindDelimiter(start, input + size);
+            pos = stop - input;
+            if (pos == size) {
+                if (!splitKey(start, stop)) {
+                    pos = (start - input) + keyRoom();
+                    fail(ErrorKeyTooLong);
+                }
+                continue;
+            }
+
+            if (!endKey(start, stop)) {
+                pos = (start - input) + keyRoom();
+                fail(ErrorKeyTooLong);
+                continue;
+            }
 
+            c = input[pos];
+            if (c == '\r') {
                 if (keys.size() == 0) {
-                    throw std::runtime_error("Client provides no key to retrive");
+                    fail(ErrorNoKey);
+                    continue;
                 }
 
-                curKey.clear();
                 state = State::sLF;
             } else if (c == ' ') {
-                // std::cout << "parser debug: key[" << keys.size() << "]='" << curKey << "'" << std::endl;
                 state = State::sgKey;
-                keys.push_back(curKey);
-                curKey.clear();
-            } else {
-                curKey.push_back(c);
             }
             break;
         }
 
+        case State::smKey: {
+            // Key of the meta command is followed either by flags or by the end of line
+            const char *start = input + pos;
+            const char *stop = FindDelimiter(start, input + size);
+            pos = stop - input;
+            if (pos == size) {
+                if (!splitKey(start, stop)) {
+                    pos = (start - input) + keyRoom();
+                    fail(ErrorKeyTooLong);
+                }
+                continue;
+            }
+
+            if (!endKey(start, stop)) {
+                pos = (start - input) + keyRoom();
+                fail(ErrorKeyTooLong);
+                continue;
+            }
+            state = (input[pos] == '\r') ? State::sLF : State::smFlags;
+            break;
+        }
+
+        case State::smFlags: {
+            // Flags are parsed out once command is built, for now just collect the rest of line
+            const char *start = input + pos;
+            const char *stop = static_cast<const char *>(std::memchr(start, '\r', size - pos));
+            const char *end = (stop == nullptr) ? input + size : stop;
+            if (meta.size() + (end - start) > MaxMetaSize) {
+                pos = (start - input) + (MaxMetaSize - meta.size());
+                fail(ErrorBadMetaFlags);
+                continue;
+            }
+
+            meta.append(start, end);
+            pos = end - input;
+            if (stop == nullptr) {
+                continue;
+            }
+            state = State::sLF;
+            break;
+        }
+
         case State::spFlags: {
             if (c == ' ') {
                 negative = false;
                 state = State::spExprTimeStart;
-                // std::cout << "parser debug: flags='" << flags << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
                 uint32_t f = (flags * 10) + (c - '0');
                 if (f < flags) {
-                    // Overflow
-                    throw std::runtime_error("Flags field overflow");
+                    fail(ErrorOverflow);
+                    continue;
                 }
                 flags = f;
             }
@@ -107,18 +222,19 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::spExprTime: {
             if (c == ' ') {
                 state = State::spBytes;
-                // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
                 int32_t et = exprtime;
                 if (negative) {
                     et -= (c - '0');
                     if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
+                        fail(ErrorOverflow);
+                        continue;
                     }
                 } else {
                     et += (c - '0');
                     if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
+                        fail(ErrorOverflow);
+                        continue;
                     }
                 }
                 exprtime = et;
@@ -129,32 +245,77 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::spBytes: {
             if (c == '\r') {
                 state = State::sLF;
-                // std::cout << "parser debug: bytes='" << bytes << "'" << std::endl;
+            } else if (c == ' ') {
+                state = State::spNoreply;
+                noreply_pos = 0;
             } else if (c >= '0' && c <= '9') {
                 uint32_t b = (bytes * 10) + (c - '0');
                 if (b < bytes) {
-                    // Overflow
-                    throw std::runtime_error("Bytes field overflow");
+                    fail(ErrorOverflow);
+                    continue;
                 }
                 bytes = b;
             }
             break;
         }
 
+        case State::spNoreply: {
+            // Optional "noreply" is the last token of storage command, trailing space is fine as well
+            static const char token[] = "noreply";
+            if (c == '\r') {
+                if (noreply_pos != 0 && noreply_pos != sizeof(token) - 1) {
+                    fail(ErrorBadNoreply);
+                    continue;
+                }
+                noreply = (noreply_pos != 0);
+                state = State::sLF;
+            } else if (noreply_pos < sizeof(token) - 1 && c == token[noreply_pos]) {
+                noreply_pos++;
+            } else {
+                fail(ErrorBadNoreply);
+                continue;
+            }
+            break;
+        }
+
         case State::sLF: {
             if (c == '\n') {
                 parse_complete = true;
             } else {
-                std::stringstream err;
-                err << "Invalid char " << (int)c << " at position " << (parsed + pos) << ", \\n expected";
-                throw std::runtime_error(err.str());
+                fail(ErrorBadFormat);
+                continue;
+            }
+            break;
+        }
+
+        case State::sSkip: {
+            // Malformed line is dropped up to its end, the next line is a new command
+            const char *lf = static_cast<const char *>(std::memchr(input + pos, '\n', size - pos));
+            if (lf == nullptr) {
+                pos = size;
+                continue;
+            }
+
+            pos = lf - input;
+            if (error != nullptr) {
+                parse_complete = true;
+            } else {
+                Reset();
             }
             break;
         }
 
         default:
-            throw std::runtime_error("Unknown state");
+            fail(ErrorBadFormat);
+            continue;
         }
+
+        pos++;
+    }
+
+    // Input is going to be overwritten before the command is complete
+    if (!parse_complete) {
+        keepKeys();
     }
 
     parsed += pos;
@@ -162,24 +323,68 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
 }
 
 // See Parse.h
-std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
+bool Parser::Build(Execute::AnyCommand &cmd, size_t &body_size) {
     if (state != State::sLF) {
-        return std::unique_ptr<Execute::Command>(nullptr);
+        return false;
     }
 
+    cmd.reset();
+    body = (command == CommandId::Set || command == CommandId::Add || command == CommandId::Replace ||
+            command == CommandId::Append || command == CommandId::Prepend);
     body_size = bytes;
-    if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
-    } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
-    } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
-    } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
-    } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
-    } else {
-        throw std::runtime_error("Unsupported command");
+    switch (command) {
+    case CommandId::Set:
+        bindKeys(cmd);
+        cmd.emplace<Execute::Set>(cmd.keys()[0], flags, exprtime);
+        return true;
+    case CommandId::Add:
+        bindKeys(cmd);
+        cmd.emplace<Execute::Add>(cmd.keys()[0], flags, exprtime);
+        return true;
+    case CommandId::Replace:
+        bindKeys(cmd);
+        cmd.emplace<Execute::Replace>(cmd.keys()[0], flags, exprtime);
+        return true;
+    case CommandId::Append:
+        bindKeys(cmd);
+        cmd.emplace<Execute::Append>(cmd.keys()[0], flags, exprtime);
+        return true;
+    case CommandId::Get:
+        bindKeys(cmd);
+        cmd.emplace<Execute::Get>(cmd.keys());
+        return true;
+    case CommandId::Stats:
+        cmd.emplace<Execute::Stats>();
+        return true;
+    case CommandId::MetaGet:
+    case CommandId::MetaSet:
+    case CommandId::MetaDelete: {
+        Execute::MetaFlags meta_flags;
+        error = metaFlags(meta_flags);
+        body_size = bytes;
+        if (keys.size() != 1 || keys[0].size == 0) {
+            error = ErrorNoKey;
+        }
+        if (error != nullptr) {
+            return false;
+        }
+
+        bindKeys(cmd);
+        if (command == CommandId::MetaGet) {
+            cmd.emplace<Execute::MetaGet>(cmd.keys()[0], meta_flags);
+        } else if (command == CommandId::MetaDelete) {
+            cmd.emplace<Execute::MetaDelete>(cmd.keys()[0], meta_flags);
+        } else {
+            cmd.emplace<Execute::MetaSet>(cmd.keys()[0], meta_flags);
+        }
+        return true;
+    }
+    case CommandId::MetaNoop:
+        cmd.emplace<Execute::MetaNoop>();
+        return true;
+    default:
+        error = ErrorNotSupported;
+        return false;
     }
 }
 
@@ -187,13 +392,165 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
 void Parser::Reset() {
     state = State::sName;
     name.clear();
+    command = CommandId::Unknown;
+    meta.clear();
+    noreply = false;
+    body = false;
+    error = nullptr;
     keys.clear();
-    curKey.clear();
+    _key.clear();
+    _scratch.clear();
     parse_complete = false;
     flags = 0;
     bytes = 0;
     exprtime = 0;
 }
 
+// See Parse.h
+void Parser::Resync() {
+    Reset();
+    state = State::sSkip;
+}
+
+// See Parse.h
+void Parser::fail(const char *reason) {
+    error = reason;
+    state = State::sSkip;
+}
+
+// See Parse.h
+bool Parser::splitKey(const char *start, const char *stop) {
+    if (_key.size() + (stop - start) > MaxKeySize) {
+        return false;
+    }
+    _key.append(start, stop);
+    return true;
+}
+
+// See Parse.h
+bool Parser::endKey(const char *start, const char *stop) {
+    if (_key.size() + (stop - start) > MaxKeySize) {
+        return false;
+    }
+
+    if (_key.empty()) {
+        keys.push_back({start, 0, size_t(stop - start)});
+    } else {
+        keys.push_back({nullptr, _scratch.size(), _key.size() + (stop - start)});
+        _scratch.append(_key);
+        _scratch.append(start, stop);
+        _key.clear();
+    }
+    return true;
+}
+
+// See Parse.h
+void Parser::keepKeys() {
+    for (auto &k : keys) {
+        if (k.data != nullptr) {
+            k.offset = _scratch.size();
+            _scratch.append(k.data, k.size);
+            k.data = nullptr;
+        }
+    }
+}
+
+// See Parse.h
+size_t Parser::keyRoom() const { return MaxKeySize - _key.size(); }
+
+// See Parse.h
+void Parser::bindKeys(Execute::AnyCommand &cmd) const {
+    // Command with body outlives the input, the rest are executed while input is still in place. Space is
+    // reserved upfront so that references into the scratch aren't invalidated by appends
+    bool detach = WithBody();
+    size_t total = 0;
+    for (auto &k : keys) {
+        if (detach || k.data == nullptr) {
+            total += k.size;
+        }
+    }
+
+    std::string &scratch = cmd.scratch();
+    scratch.reserve(total);
+    for (auto &k : keys) {
+        if (detach || k.data == nullptr) {
+            StringRef bytes = key(k);
+            cmd.keys().push_back(StringRef(scratch.data() + scratch.size(), bytes.size()));
+            scratch.append(bytes.data(), bytes.size());
+        } else {
+            cmd.keys().push_back(StringRef(k.data, k.size));
+        }
+    }
+}
+
+// See Parse.h
+const char *Parser::metaFlags(Execute::MetaFlags &flags) {
+    bool datalen_expected = (command == CommandId::MetaSet);
+    size_t pos = 0;
+    while (pos < meta.size()) {
+        size_t end = meta.find(' ', pos);
+        if (end == std::string::npos) {
+            end = meta.size();
+        }
+
+        // Flag is a single letter, optionally followed by the token
+        const char *token = meta.data() + pos;
+        size_t token_size = end - pos;
+        pos = end + 1;
+        if (token_size == 0) {
+            continue;
+        }
+
+        if (datalen_expected) {
+            uint32_t v = 0;
+            for (size_t i = 0; i < token_size; i++) {
+                if (token[i] < '0' || token[i] > '9' || v > (UINT32_MAX - 9) / 10) {
+                    return ErrorBadFormat;
+                }
+                v = v * 10 + (token[i] - '0');
+            }
+
+            // Data block follows even if the rest of flags is wrong, so it could be skipped
+            bytes = v;
+            body = true;
+            datalen_expected = false;
+            continue;
+        }
+
+        switch (token[0]) {
+        case 'q':
+            flags.quiet = true;
+            break;
+        case 'v':
+            flags.value = true;
+            break;
+        case 't':
+        case 'c':
+        case 'f':
+        case 's':
+        case 'k':
+            flags.returned.push_back(token[0]);
+            break;
+        case 'O':
+            flags.opaque.assign(token + 1, token_size - 1);
+            flags.returned.push_back('O');
+            break;
+        case 'M':
+            if (token_size != 2 || std::strchr("SERAP", token[1]) == nullptr) {
+                return ErrorBadMetaFlags;
+            }
+            flags.mode = token[1];
+            break;
+        case 'T':
+        case 'F':
+            break;
+        default:
+            return ErrorBadMetaFlags;
+        }
+    }
+
+    return datalen_expected ? ErrorBadFormat : nullptr;
+}
+
 } // namespace Protocol
 } // namespace Afina
@@ -1,16 +1,20 @@
 #ifndef AFINA_PROTOCOL_PARSER_H
 #define AFINA_PROTOCOL_PARSER_H
 
-#include <memory>
 #include <string>
 #include <vector>
 
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/StringRef.h>
+
+#include "Commands.h"
+
 namespace Afina {
 namespace Execute {
-class Command;
+class AnyCommand;
+struct MetaFlags;
 } // namespace Execute
 namespace Protocol {
 
@@ -31,10 +35,20 @@ public:
      */
     bool Parse(const std::string &input, size_t &parsed) { return Parse(&input[0], input.size(), parsed); }
 
+    /**
+     * Parsed command references input, so it must not be a temporary
+     */
+    bool Parse(std::string &&input, size_t &parsed) = delete;
+
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
      * from comulative input. In a such case method Build will return new command
      *
+     * Parser doesn't copy keys which are entirely inside of the input, it keeps references to them instead.
+     * So caller must keep consumed bytes in place until command built out of them gets executed or parser
+     * reset. Only keys of the command splitted between Parse calls are copied into the parser, so that input of
+     * the previous calls could be overwritten
+     *
      * @param input string to be added to the parsed input
      * @param size number of bytes in the input buffer that could be read
      * @param parsed output parameter tells how many bytes was consumed from the string
@@ -43,17 +57,49 @@ public:
     bool Parse(const char *input, const size_t size, size_t &parsed);
 
     /**
-     * Builds new command from parsed input. In case if it wasn't enough input to prse command out
-     * method return nullptr
+     * Builds new command from parsed input in place of the given one. In case if it wasn't enough input to
+     * parse command out, or command is malformed, method returns false. Reason of the failure is given by Error
+     *
+     * Command without body references keys in the parser input, so it must be executed before input gets
+     * overwritten. Command having a body gets keys copied into the cmd, as body is going to arrive later.
+     * Keys of the command splitted between Parse calls are always copied into the cmd, so parser could be reset
+     * right after the Build and used to parse next command while this one waits for execution
      */
-    std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
+    bool Build(Execute::AnyCommand &cmd, size_t &body_size);
 
     /**
      * Reset parse so that it could be used to parse out new command
      */
     void Reset();
 
+    /**
+     * Reset parser and drop the input up to the end of the current line, for example the rest of data block which
+     * turned out to be longer than announced. Nothing is parsed out of dropped bytes
+     */
+    void Resync();
+
+    /**
+     * Returns response to the malformed command, or nullptr if command is fine. Parser doesn't throw on malformed
+     * input: it drops the rest of the line and reports it as parsed, so that client gets the error in place of
+     * the response and the next line is parsed as a new command. Response is ERROR for unknown command name and
+     * CLIENT_ERROR with the reason for the rest
+     */
+    inline const char *Error() const { return error; }
+
     inline const std::string &Name() const { return name; }
+    inline CommandId Id() const { return command; }
+
+    /**
+     * Returns true if client asked not to send response on the parsed command
+     */
+    inline bool NoReply() const { return noreply; }
+
+    /**
+     * Returns true if built command is followed by a data block, size of the block is returned by Build. Block
+     * is terminated by \r\n, which isn't counted in the size. Malformed command still has the block if its size
+     * is known, client is going to send it anyway
+     */
+    inline bool WithBody() const { return body; }
 
 private:
     /**
@@ -61,15 +107,67 @@ private:
      * - s: state for PUT and GET commands
      * - sp: for PUT commands only
      * - sg: for GET commands only
+     * - sm: for meta commands
      */
-    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
+    enum State : uint16_t {
+        sCR,
+        sLF,
+        sName,
+        spKey,
+        spFlags,
+        spExprTimeStart,
+        spExprTime,
+        spBytes,
+        spNoreply,
+        sgKey,
+        smKey,
+        smFlags,
+        sSkip
+    };
 
     // Current parser state
     State state;
 
+    // Key of the command, either reference to the parser input or, if command was splitted between Parse calls or
+    // key has to outlive the input, a part of the _scratch buffer
+    struct key_ref {
+        const char *data;
+        size_t offset;
+        size_t size;
+    };
+
+    // Returns reference to the key bytes, wherever they are
+    inline StringRef key(const key_ref &k) const {
+        return (k.data != nullptr) ? StringRef(k.data, k.size) : StringRef(_scratch.data() + k.offset, k.size);
+    }
+
+    // Give up on the current command: skip the rest of the line and report reason once line is over
+    void fail(const char *reason);
+
+    // Current key continues in the next Parse call, save what we have got so far. Returns false if key is too long
+    bool splitKey(const char *start, const char *stop);
+
+    // Finish current key, which is ends right before stop. Returns false if key is too long
+    bool endKey(const char *start, const char *stop);
+
+    // Copy keys referencing the input into the _scratch, as command continues in the next Parse call
+    void keepKeys();
+
+    // Number of bytes current key could grow by. Too long key fails right at the first byte over the limit, so
+    // the line is dropped from the same place however input is splitted
+    size_t keyRoom() const;
+
+    // Resolve keys into the command place, copying those which are not going to stay in the input
+    void bindKeys(Execute::AnyCommand &cmd) const;
+
+    // Parse flags of the meta command, for ms the first token is a data length and it goes into bytes. Returns
+    // response to the malformed command or nullptr
+    const char *metaFlags(Execute::MetaFlags &flags);
+
     // vrious fields of the command
     std::string name;
-    std::vector<std::string> keys;
+    CommandId command;
+    std::vector<key_ref> keys;
 
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
     // the data and sends back when the item is retrieved. Clients may use this as a bit field to store data-specific
@@ -88,9 +186,27 @@ private:
     // it's followed by an empty data block).
     uint32_t bytes;
 
+    // Flags of the meta command, everything after the key up to the end of line
+    std::string meta;
+
     bool negative;
-    std::string curKey;
     bool parse_complete;
+
+    // Command is followed by a data block
+    bool body;
+
+    // Response to the malformed command, nullptr if command is fine
+    const char *error;
+
+    // Storage command ends by "noreply", position of the next expected char of it
+    bool noreply;
+    size_t noreply_pos;
+
+    // Part of the current key got from previous Parse calls
+    std::string _key;
+
+    // Keys storage, keeps capacity between commands
+    std::string _scratch;
 };
 
 } // namespace Protocol
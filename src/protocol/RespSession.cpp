@@ -0,0 +1,450 @@
+#include "RespSession.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+#include <afina/Storage.h>
+
+#include "Commands.h"
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Limits protecting from clients announcing huge requests. Bulk follows memcached default item limit, as the
+// memcached protocols do, and the whole request is bounded, so session never buffers more than a couple of MB
+const size_t MaxLineSize = 64 * 1024;
+const int64_t MaxArguments = 4096;
+const int64_t MaxBulkSize = 1024 * 1024;
+const int64_t MaxRequestSize = 2 * MaxBulkSize;
+
+// Response to the request refused because of its size
+const char ErrorTooLarge[] = "Protocol error: request is too large";
+
+// Storage can't expire keys later, so commands asking for it are refused
+const char ErrorNoExpire[] = "expire times are not supported";
+
+enum class RespCommand : uint8_t { Unknown, Get, Set, MGet, Del, Incr, Expire, Ping };
+
+// Command names are case insensitive, so name gets lowered before lookup
+RespCommand LookupRespCommand(StringRef name) {
+    char lower[8];
+    if (name.size() > sizeof(lower)) {
+        return RespCommand::Unknown;
+    }
+    for (size_t i = 0; i < name.size(); i++) {
+        lower[i] = std::tolower(static_cast<unsigned char>(name[i]));
+    }
+
+#define AFINA_RESP_COMMAND(str, id)                                                                                \
+    case HashName(str):                                                                                            \
+        return (name.size() == sizeof(str) - 1 && std::memcmp(lower, str, name.size()) == 0) ? RespCommand::id       \
+                                                                                           : RespCommand::Unknown;
+
+    switch (HashName(lower, name.size())) {
+        AFINA_RESP_COMMAND("get", Get)
+        AFINA_RESP_COMMAND("set", Set)
+        AFINA_RESP_COMMAND("mget", MGet)
+        AFINA_RESP_COMMAND("del", Del)
+        AFINA_RESP_COMMAND("incr", Incr)
+        AFINA_RESP_COMMAND("expire", Expire)
+        AFINA_RESP_COMMAND("ping", Ping)
+    default:
+        return RespCommand::Unknown;
+    }
+
+#undef AFINA_RESP_COMMAND
+}
+
+// Returns pointer to the \r of the \r\n finishing line started at begin, or nullptr if line isn't complete yet
+const char *LineEnd(const char *begin, const char *end) {
+    const char *cr = static_cast<const char *>(std::memchr(begin, '\r', end - begin));
+    if (cr == nullptr || cr + 1 == end) {
+        if (size_t(end - begin) > MaxLineSize) {
+            throw std::runtime_error("Protocol error: too big line");
+        }
+        return nullptr;
+    }
+    if (cr[1] != '\n') {
+        throw std::runtime_error("Protocol error: \\r\\n expected");
+    }
+    return cr;
+}
+
+// Parses signed decimal integer, returns false if there is anything else
+bool ParseInt(StringRef s, int64_t &result) {
+    size_t i = 0;
+    bool negative = false;
+    if (s.size() > 0 && s[0] == '-') {
+        negative = true;
+        i = 1;
+    }
+    if (i == s.size() || s.size() > 20) {
+        return false;
+    }
+
+    uint64_t v = 0;
+    for (; i < s.size(); i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+        v = v * 10 + (s[i] - '0');
+        if (v > uint64_t(INT64_MAX) + (negative ? 1 : 0)) {
+            return false;
+        }
+    }
+
+    result = negative ? int64_t(0 - v) : int64_t(v);
+    return true;
+}
+
+// Response encoders
+void Bulk(Execute::Output &out, StringRef value) {
+    out.push_back('$');
+    out.append(std::to_string(value.size()));
+    out.append("\r\n");
+    out.append(value.data(), value.size());
+    out.append("\r\n");
+}
+
+void Nil(Execute::Output &out) { out.append("$-1\r\n"); }
+
+void Integer(Execute::Output &out, int64_t value) {
+    out.push_back(':');
+    out.append(std::to_string(value));
+    out.append("\r\n");
+}
+
+void Error(Execute::Output &out, const std::string &message) {
+    out.append("-ERR ");
+    out.append(message);
+    out.append("\r\n");
+}
+
+void WrongArity(Execute::Output &out, StringRef name) {
+    Error(out, "wrong number of arguments for '" + name.str() + "' command");
+}
+
+} // namespace
+
+// See RespSession.h
+size_t RespSession::Process(const char *input, size_t size, Execute::Output &out) {
+    // Continue request started in the one of previous calls
+    const char *data = input;
+    size_t data_size = size;
+    if (!_pending.empty()) {
+        _pending.append(input, size);
+        data = _pending.data();
+        data_size = _pending.size();
+    }
+
+    size_t pos = 0;
+    while (pos < data_size) {
+        if (!Parse(data + pos, data_size - pos)) {
+            break;
+        }
+
+        Execute(out);
+        pos += _done;
+        ResetRequest();
+    }
+
+    // Keep incomplete request. Bytes of the refused one are never used, so only the part not parsed yet is kept
+    size_t keep = pos;
+    if (_error != nullptr) {
+        keep += _done;
+        _done = 0;
+    }
+    if (data == input) {
+        _pending.assign(input + keep, size - keep);
+    } else {
+        _pending.erase(0, keep);
+    }
+    return size;
+}
+
+// See RespSession.h
+void RespSession::Reset() {
+    _pending.clear();
+    ResetRequest();
+}
+
+// See RespSession.h
+void RespSession::ResetRequest() {
+    _args.clear();
+    _spans.clear();
+    _done = 0;
+    _count = -1;
+    _arg = 0;
+    _skip = 0;
+    _error = nullptr;
+}
+
+// See RespSession.h
+bool RespSession::Parse(const char *input, size_t size) {
+    const char *p = input + _done, *end = input + size;
+
+    // Inline command: single line of words
+    if (*input != '*') {
+        const char *lf = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (lf == nullptr) {
+            if (size > MaxLineSize) {
+                throw std::runtime_error("Protocol error: too big inline request");
+            }
+            _done = size;
+            return false;
+        }
+
+        p = input;
+        const char *stop = (lf > p && lf[-1] == '\r') ? lf - 1 : lf;
+        while (p < stop) {
+            const char *space = static_cast<const char *>(std::memchr(p, ' ', stop - p));
+            const char *word_end = (space == nullptr) ? stop : space;
+            if (word_end > p) {
+                _args.push_back(StringRef(p, word_end - p));
+            }
+            p = word_end + 1;
+        }
+        _done = lf + 1 - input;
+        return true;
+    }
+
+    // Array of bulk strings, parsing continues right after the last complete header or argument
+    if (_count < 0) {
+        const char *eol = LineEnd(p + 1, end);
+        if (eol == nullptr) {
+            return false;
+        }
+
+        int64_t count;
+        if (!ParseInt(StringRef(p + 1, eol - p - 1), count) || count < 0 || count > MaxArguments) {
+            throw std::runtime_error("Protocol error: invalid multibulk length");
+        }
+        _count = count;
+        p = eol + 2;
+        _done = p - input;
+    }
+
+    while (_arg < _count) {
+        // Bulk of the refused request is dropped as it arrives
+        if (_skip > 0) {
+            size_t skipped = std::min(_skip, size_t(end - p));
+            _skip -= skipped;
+            p += skipped;
+            _done = p - input;
+            if (_skip > 0) {
+                return false;
+            }
+            _arg++;
+            continue;
+        }
+
+        if (p == end) {
+            return false;
+        }
+        if (*p != '$') {
+            throw std::runtime_error("Protocol error: '$' expected");
+        }
+
+        const char *eol = LineEnd(p + 1, end);
+        if (eol == nullptr) {
+            return false;
+        }
+
+        int64_t length;
+        if (!ParseInt(StringRef(p + 1, eol - p - 1), length) || length < 0) {
+            throw std::runtime_error("Protocol error: invalid bulk length");
+        }
+        const char *bulk = eol + 2;
+
+        // Request over the limit is refused, the rest of it is skipped without being kept
+        if (_error != nullptr || length > MaxBulkSize || (bulk - input) + length + 2 > MaxRequestSize) {
+            _error = ErrorTooLarge;
+            _spans.clear();
+            _skip = length + 2;
+            p = bulk;
+            _done = p - input;
+            continue;
+        }
+
+        if (end - bulk < length + 2) {
+            return false;
+        }
+        if (bulk[length] != '\r' || bulk[length + 1] != '\n') {
+            throw std::runtime_error("Protocol error: bulk isn't terminated by \\r\\n");
+        }
+
+        _spans.emplace_back(bulk - input, length);
+        p = bulk + length + 2;
+        _done = p - input;
+        _arg++;
+    }
+
+    // Input doesn't move anymore, so arguments could reference it
+    for (auto &span : _spans) {
+        _args.push_back(StringRef(input + span.first, span.second));
+    }
+    return true;
+}
+
+// See RespSession.h
+void RespSession::Execute(Execute::Output &out) {
+    if (_error != nullptr) {
+        return Error(out, _error);
+    }
+    if (_args.empty()) {
+        return;
+    }
+
+    StringRef name = _args[0];
+    size_t argc = _args.size();
+    switch (LookupRespCommand(name)) {
+    case RespCommand::Get: {
+        if (argc != 2) {
+            return WrongArity(out, name);
+        }
+
+        std::string value;
+        if (pStorage->Get(_args[1], value)) {
+            Bulk(out, value);
+        } else {
+            Nil(out);
+        }
+        return;
+    }
+
+    case RespCommand::Set: {
+        if (argc < 3) {
+            return WrongArity(out, name);
+        }
+
+        bool nx = false, xx = false;
+        for (size_t i = 3; i < argc; i++) {
+            std::string option = _args[i].str();
+            for (auto &c : option) {
+                c = std::toupper(static_cast<unsigned char>(c));
+            }
+
+            int64_t ttl;
+            if (option == "NX") {
+                nx = true;
+            } else if (option == "XX") {
+                xx = true;
+            } else if ((option == "EX" || option == "PX") && i + 1 < argc) {
+                if (!ParseInt(_args[++i], ttl) || ttl <= 0) {
+                    return Error(out, "invalid expire time in 'set' command");
+                }
+                return Error(out, ErrorNoExpire);
+            } else {
+                return Error(out, "syntax error");
+            }
+        }
+        if (nx && xx) {
+            return Error(out, "syntax error");
+        }
+
+        // Condition not met is reported by nil
+        std::string value = _args[2].str();
+        if (nx && !pStorage->PutIfAbsent(_args[1], value)) {
+            return Nil(out);
+        } else if (xx && !pStorage->Set(_args[1], value)) {
+            return Nil(out);
+        } else if (!nx && !xx && !pStorage->Put(_args[1], value)) {
+            return Error(out, "value is too large to be stored");
+        }
+        out.append("+OK\r\n");
+        return;
+    }
+
+    case RespCommand::MGet: {
+        if (argc < 2) {
+            return WrongArity(out, name);
+        }
+
+        out.push_back('*');
+        out.append(std::to_string(argc - 1));
+        out.append("\r\n");
+
+        std::string value;
+        for (size_t i = 1; i < argc; i++) {
+            if (pStorage->Get(_args[i], value)) {
+                Bulk(out, value);
+            } else {
+                Nil(out);
+            }
+        }
+        return;
+    }
+
+    case RespCommand::Del: {
+        if (argc < 2) {
+            return WrongArity(out, name);
+        }
+
+        int64_t deleted = 0;
+        for (size_t i = 1; i < argc; i++) {
+            deleted += pStorage->Delete(_args[i]) ? 1 : 0;
+        }
+        return Integer(out, deleted);
+    }
+
+    case RespCommand::Incr: {
+        if (argc != 2) {
+            return WrongArity(out, name);
+        }
+
+        // Read and write go in one batch, so increments of the concurrent clients aren't lost in between
+        int64_t current = 0;
+        const char *error = nullptr;
+        pStorage->Batch([this, &current, &error](Storage &storage) {
+            std::string value;
+            if (storage.Get(_args[1], value) && !ParseInt(value, current)) {
+                error = "value is not an integer or out of range";
+            } else if (current == INT64_MAX) {
+                error = "increment or decrement would overflow";
+            } else if (!storage.Put(_args[1], std::to_string(++current))) {
+                error = "value is too large to be stored";
+            }
+        });
+        if (error != nullptr) {
+            return Error(out, error);
+        }
+        return Integer(out, current);
+    }
+
+    case RespCommand::Expire: {
+        if (argc != 3) {
+            return WrongArity(out, name);
+        }
+
+        int64_t seconds;
+        if (!ParseInt(_args[2], seconds)) {
+            return Error(out, "value is not an integer or out of range");
+        }
+        if (seconds > 0) {
+            return Error(out, ErrorNoExpire);
+        }
+
+        // Key expires right away
+        return Integer(out, pStorage->Delete(_args[1]) ? 1 : 0);
+    }
+
+    case RespCommand::Ping:
+        if (argc > 2) {
+            return WrongArity(out, name);
+        } else if (argc == 2) {
+            return Bulk(out, _args[1]);
+        }
+        out.append("+PONG\r\n");
+        return;
+
+    default:
+        return Error(out, "unknown command '" + name.str() + "'");
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
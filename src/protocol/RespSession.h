@@ -0,0 +1,76 @@
+#ifndef AFINA_PROTOCOL_RESP_SESSION_H
+#define AFINA_PROTOCOL_RESP_SESSION_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/StringRef.h>
+
+#include "Session.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Redis protocol (RESP2) session
+ * Request is an array of bulk strings, for example "*2\r\n$3\r\nGET\r\n$3\r\nfoo\r\n", or, for hand typed
+ * commands, a single line of space separated words. First element is a command name, case insensitive,
+ * the rest are arguments. Supported commands are:
+ * - GET key, SET key value [EX seconds|PX milliseconds] [NX|XX]
+ * - MGET key [key ...], DEL key [key ...]
+ * - INCR key
+ * - EXPIRE key seconds
+ * - PING [message]
+ *
+ * Storage has no notion of time to live, so SET with EX/PX and EXPIRE with positive timeout are refused with
+ * error rather than reported as done. EXPIRE with non-positive timeout deletes the key
+ *
+ * Request splitted between reads is collected and parsed from where the previous read stopped. Bulk over 1 MB or
+ * request over 2 MB is refused with error, its bytes are dropped as they arrive instead of being buffered
+ */
+class RespSession : public Session {
+public:
+    RespSession(std::shared_ptr<Afina::Storage> storage) : Session(storage) { ResetRequest(); }
+    ~RespSession() {}
+
+    // See Session.h
+    size_t Process(const char *input, size_t size, Execute::Output &out) override;
+
+    // See Session.h
+    void Reset() override;
+
+private:
+    // Continues parsing of the request starting at input. Returns true once request is complete, then _done is
+    // the number of bytes it occupies and arguments reference input
+    bool Parse(const char *input, size_t size);
+
+    // Executes request parsed last, or responds with error if request is refused
+    void Execute(Execute::Output &out);
+
+    // Forgets progress of the current request
+    void ResetRequest();
+
+    // Arguments of the request parsed last, name included
+    std::vector<StringRef> _args;
+
+    // Incomplete request got from previous Process calls
+    std::string _pending;
+
+    // Progress of the current request: bytes parsed from its start, number of arguments announced or -1 if
+    // header isn't parsed yet, index of the next argument, and arguments parsed so far as offsets from the start
+    size_t _done;
+    int64_t _count;
+    int64_t _arg;
+    std::vector<std::pair<size_t, size_t>> _spans;
+
+    // Response to the refused request, nullptr if request is fine. Bytes left of the bulk being dropped
+    const char *_error;
+    size_t _skip;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_RESP_SESSION_H
@@ -0,0 +1,70 @@
+#ifndef AFINA_PROTOCOL_SCANNER_H
+#define AFINA_PROTOCOL_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Token boundaries search
+ * Memcached text protocol separates tokens by space and finishes command line by \r\n, so parser spends most of
+ * time looking for the next ' ' or '\r'. Functions below do it for the whole chunk at once, comparing 32 (AVX2)
+ * or 16 (SSE2) bytes per instruction. Which one is used is decided at compile time, by -march.
+ */
+
+/**
+ * Returns pointer to the first ' ' or '\r' in [begin, end), or end if there is no one. Byte by byte version,
+ * used for tails shorter than vector register and on platforms without SIMD
+ */
+inline const char *FindDelimiterScalar(const char *begin, const char *end) {
+    for (; begin < end; begin++) {
+        if (*begin == ' ' || *begin == '\r') {
+            return begin;
+        }
+    }
+    return end;
+}
+
+/**
+ * Returns pointer to the first ' ' or '\r' in [begin, end), or end if there is no one
+ */
+inline const char *FindDelimiter(const char *begin, const char *end) {
+#if defined(__AVX2__)
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    for (; end - begin >= 32; begin += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space32), _mm256_cmpeq_epi8(chunk, cr32));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i space16 = _mm_set1_epi8(' ');
+    const __m128i cr16 = _mm_set1_epi8('\r');
+    for (; end - begin >= 16; begin += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, space16), _mm_cmpeq_epi8(chunk, cr16));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    return FindDelimiterScalar(begin, end);
+}
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_SCANNER_H
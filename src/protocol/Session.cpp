@@ -0,0 +1,27 @@
+#include "Session.h"
+
+#include "BinarySession.h"
+#include "TextSession.h"
+
+namespace Afina {
+namespace Protocol {
+
+// See Session.h
+std::unique_ptr<Session> Session::Detect(char first, std::shared_ptr<Afina::Storage> storage,
+                                         std::unique_ptr<Session> reuse) {
+    bool binary = (uint8_t(first) == BinarySession::RequestMagic);
+    Session *ps = reuse.get();
+    if (ps != nullptr && (binary ? dynamic_cast<BinarySession *>(ps) != nullptr
+                                 : dynamic_cast<TextSession *>(ps) != nullptr)) {
+        reuse->Reset();
+        return reuse;
+    }
+
+    if (binary) {
+        return std::unique_ptr<Session>(new BinarySession(storage));
+    }
+    return std::unique_ptr<Session>(new TextSession(storage));
+}
+
+} // namespace Protocol
+} // namespace Afina
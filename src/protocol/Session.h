@@ -0,0 +1,83 @@
+#ifndef AFINA_PROTOCOL_SESSION_H
+#define AFINA_PROTOCOL_SESSION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <afina/execute/Output.h>
+
+namespace Afina {
+
+class Storage;
+
+namespace Protocol {
+
+/**
+ * # Protocol side of the client connection
+ * Session consumes bytes received from the client, runs requests found there against the storage and produces
+ * bytes to be sent back. Network layer only moves bytes between socket and session, so the same connection code
+ * serves any protocol.
+ */
+class Session {
+public:
+    Session(std::shared_ptr<Afina::Storage> storage) : pStorage(storage) {}
+    virtual ~Session() {}
+
+    /**
+     * Process next chunk of client input. Responses to all requests completed by the chunk are appended to the
+     * out. Request could be splitted between any number of chunks, session keeps parts it needs, so once method
+     * returns consumed bytes could be dropped by the caller.
+     *
+     * Method throws std::runtime_error if input violates protocol, connection should be closed in such case
+     *
+     * @param input bytes received from the client
+     * @param size number of bytes in the input
+     * @param out buffer to append responses to
+     * @return number of bytes consumed from the input, the rest must be passed again along with new data
+     */
+    virtual size_t Process(const char *input, size_t size, Execute::Output &out) = 0;
+
+    /**
+     * Returns place the next bytes of the stream should be read into instead of being passed to Process, or
+     * nullptr if there is no such place. Session offers it while waiting for the data block it already knows size
+     * of, so that block gets read right into the buffer going to be stored rather than copied there chunk by
+     * chunk. Caller must not have unprocessed input when using the place.
+     *
+     * @param size output parameter, number of bytes the place could take
+     * @return pointer to the place or nullptr
+     */
+    virtual char *DirectBuffer(size_t &size) { return nullptr; }
+
+    /**
+     * Tells session that bytes were read into the place returned by DirectBuffer. Responses to requests completed
+     * by the bytes are appended to the out
+     *
+     * @param size number of bytes read, not more than the place size
+     * @param out buffer to append responses to
+     */
+    virtual void DirectFilled(size_t size, Execute::Output &out) {}
+
+    /**
+     * Forget the client: requests received partially are dropped, so that session could serve the next connection.
+     * Buffers keep their capacity
+     */
+    virtual void Reset() = 0;
+
+    /**
+     * Creates session for the protocol client speaks, judging by the first byte client sent: memcached binary
+     * protocol requests start from magic 0x80, anything else is considered to be text protocol.
+     *
+     * Session of the previous client given as reuse is reset and returned back if it speaks the same protocol
+     */
+    static std::unique_ptr<Session> Detect(char first, std::shared_ptr<Afina::Storage> storage,
+                                           std::unique_ptr<Session> reuse = nullptr);
+
+protected:
+    std::shared_ptr<Afina::Storage> pStorage;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_SESSION_H
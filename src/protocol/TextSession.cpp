@@ -0,0 +1,187 @@
+#include "TextSession.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Memcached default limit of the item size, protects from allocating whatever client announces
+const size_t MaxBodySize = 1024 * 1024;
+
+// Responses to the commands failed because of their data block
+const char ErrorTooLarge[] = "CLIENT_ERROR object too large for cache";
+const char ErrorBadChunk[] = "CLIENT_ERROR bad data chunk";
+
+} // namespace
+
+// See TextSession.h
+size_t TextSession::Process(const char *input, size_t size, Execute::Output &out) {
+    // Commands without argument reference keys inside of the input, so data is consumed by moving cursor and
+    // queued commands are executed before returning.
+    //
+    // Single block of data readed from the socket could trigger inside actions a multiple times,
+    // for example:
+    // - read#0: [<command1 start>]
+    // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    size_t begin = 0;
+    while (begin < size) {
+        // There is no command yet
+        if (_current == nullptr) {
+            size_t parsed = 0;
+            if (parser.Parse(input + begin, size - begin, parsed)) {
+                // Here we are, current chunk finished some command, build it into the queue. Data block,
+                // even empty one, is terminated by \r\n. Command has everything it needs, so parser is free
+                // for the next one
+                Request &request = nextSlot();
+                request.arg_remains = 0;
+                request.error = nullptr;
+                if (!parser.Build(request.command, request.arg_remains)) {
+                    // Malformed command gets error in place of the response
+                    request.error = parser.Error();
+                } else if (request.arg_remains > MaxBodySize) {
+                    request.command.reset();
+                    request.error = ErrorTooLarge;
+                }
+                request.with_body = parser.WithBody();
+                request.noreply = parser.NoReply();
+
+                if (request.with_body) {
+                    // Buffer for the data block is allocated at once, it goes to the storage as is. Block of
+                    // the failed command is just dropped
+                    request.arg_remains += 2;
+                    if (request.error == nullptr) {
+                        request.argument.resize(request.arg_remains);
+                    }
+                }
+
+                _current = &request;
+                parser.Reset();
+            }
+
+            // Parsed might fails to consume any bytes from input stream. In real life that could happens,
+            // for example, because we are working with UTF-16 chars and only 1 byte left in stream
+            if (parsed == 0) {
+                break;
+            } else {
+                begin += parsed;
+            }
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (_current != nullptr && _current->arg_remains > 0) {
+            size_t to_read = std::min(_current->arg_remains, size - begin);
+            if (_current->error == nullptr) {
+                std::string &argument = _current->argument;
+                std::memcpy(&argument[argument.size() - _current->arg_remains], input + begin, to_read);
+            }
+
+            _current->arg_remains -= to_read;
+            begin += to_read;
+        }
+
+        // There is command & argument - queue it
+        if (_current != nullptr && _current->arg_remains == 0) {
+            queueCurrent();
+        }
+    }
+
+    executeReady(out);
+
+    // Nothing references consumed data anymore: command waiting for argument has own copy of the key
+    return begin;
+}
+
+// See TextSession.h
+char *TextSession::DirectBuffer(size_t &size) {
+    if (_current == nullptr || _current->arg_remains == 0 || _current->error != nullptr) {
+        return nullptr;
+    }
+
+    std::string &argument = _current->argument;
+    size = _current->arg_remains;
+    return &argument[argument.size() - size];
+}
+
+// See TextSession.h
+void TextSession::DirectFilled(size_t size, Execute::Output &out) {
+    _current->arg_remains -= size;
+    if (_current->arg_remains == 0) {
+        queueCurrent();
+        executeReady(out);
+    }
+}
+
+// See TextSession.h
+void TextSession::Reset() {
+    parser.Reset();
+    _ready = 0;
+    _current = nullptr;
+}
+
+// See TextSession.h
+void TextSession::queueCurrent() {
+    if (_current->with_body && _current->error == nullptr) {
+        std::string &argument = _current->argument;
+        size_t data_size = argument.size() - 2;
+        if (argument.compare(data_size, 2, "\r\n") != 0) {
+            // Block is longer than announced, the rest of it is dropped up to the end of line
+            _current->command.reset();
+            _current->error = ErrorBadChunk;
+            if (argument.back() != '\n') {
+                parser.Resync();
+            }
+        }
+        argument.resize(data_size);
+    }
+
+    _ready++;
+    _current = nullptr;
+}
+
+// See TextSession.h
+TextSession::Request &TextSession::nextSlot() {
+    if (_batch.size() == _ready) {
+        _batch.emplace_back(new Request());
+    }
+    return *_batch[_ready];
+}
+
+// See TextSession.h
+void TextSession::executeReady(Execute::Output &out) {
+    if (_ready == 0) {
+        return;
+    }
+
+    // Client could ask to drop response by noreply, such a command doesn't make it at all
+    pStorage->Batch([this, &out](Storage &storage) {
+        for (size_t i = 0; i < _ready; i++) {
+            Request &request = *_batch[i];
+            if (request.error != nullptr) {
+                out.append(request.error);
+                out.append("\r\n", 2);
+            } else if (request.noreply) {
+                request.command.Execute(storage, request.argument);
+            } else {
+                request.command.Execute(storage, request.argument, out);
+            }
+        }
+    });
+
+    // Prepare slots for the next commands, the one waiting for argument goes first
+    for (size_t i = 0; i < _ready; i++) {
+        _batch[i]->command.reset();
+        _batch[i]->argument.resize(0);
+    }
+    if (_current != nullptr) {
+        std::swap(_batch[0], _batch[_ready]);
+    }
+    _ready = 0;
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,88 @@
+#ifndef AFINA_PROTOCOL_TEXT_SESSION_H
+#define AFINA_PROTOCOL_TEXT_SESSION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/execute/AnyCommand.h>
+
+#include "Parser.h"
+#include "Session.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Memcached text protocol session
+ * Parses commands out of the input and collects their arguments. Every command completed by the input is
+ * queued, and once input is over whole queue gets executed as a single storage batch, so pipelining clients
+ * pay for storage locks once per read instead of once per command. Responses are appended in the order
+ * commands came in.
+ *
+ * Data block is collected in the buffer of its final size, which could be filled by the network directly, see
+ * DirectBuffer, and then moved into the storage.
+ *
+ * Malformed commands never break the session: each one gets ERROR or CLIENT_ERROR response in its turn and
+ * parsing continues from the next line
+ */
+class TextSession : public Session {
+public:
+    TextSession(std::shared_ptr<Afina::Storage> storage) : Session(storage), _ready(0), _current(nullptr) {}
+    ~TextSession() {}
+
+    // See Session.h
+    size_t Process(const char *input, size_t size, Execute::Output &out) override;
+
+    // See Session.h
+    char *DirectBuffer(size_t &size) override;
+
+    // See Session.h
+    void DirectFilled(size_t size, Execute::Output &out) override;
+
+    // See Session.h
+    void Reset() override;
+
+private:
+    // Command parsed out of stream along with its argument
+    struct Request {
+        Execute::AnyCommand command;
+
+        // How many bytes to read from stream to get command argument
+        size_t arg_remains;
+
+        // Argument, data block gets allocated in full once its size is known and filled as bytes arrive
+        std::string argument;
+
+        bool with_body;
+        bool noreply;
+
+        // Response to the malformed request, which isn't executed, nullptr if request is fine
+        const char *error;
+    };
+
+    // Checks argument of the request waiting for it and marks the request ready
+    void queueCurrent();
+
+    // Returns free slot following the ready ones
+    Request &nextSlot();
+
+    // Executes ready requests and appends their responses to the out
+    void executeReady(Execute::Output &out);
+
+    // Parse state of the stream
+    Parser parser;
+
+    // Requests, first _ready of them are complete, then the one still waiting for argument might follow. Slots
+    // are reused, so command places and argument buffers keep their capacity between reads
+    std::vector<std::unique_ptr<Request>> _batch;
+    size_t _ready;
+
+    // Request waiting for argument, if any
+    Request *_current;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_TEXT_SESSION_H
@@ -17,64 +17,69 @@ SimpleLRU::~SimpleLRU() {
     _lru_head.reset();
 }
 
-bool SimpleLRU::Put(const std::string &key, const std::string &value) {
+bool SimpleLRU::Put(StringRef key, const std::string &value) { return put(key, value); }
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Put(StringRef key, std::string &&value) { return put(key, std::move(value)); }
+
+template <typename Value> bool SimpleLRU::put(StringRef key, Value &&value) {
 
     // if not have enough memory
     if (key.size() + value.size() > _max_size) {
         return false;
     }
 
-    auto it = _lru_index.find(std::ref(key));
+    auto it = _lru_index.find(key);
     if (it != _lru_index.end()) {
-        prepareLRU((int)value.size() - (int)it->second.get().value.size());
+        prepareLRU((int)value.size() - (int)it->second.get().value->size());
         moveNode(it);
-        _lru_head.get()->value = value;
+        _lru_head.get()->value = std::make_shared<const std::string>(std::forward<Value>(value));
 
     } else {
         prepareLRU(key.size() + value.size());
-        addNode(key, value);
+        addNode(key, std::make_shared<const std::string>(std::forward<Value>(value)));
     }
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+bool SimpleLRU::PutIfAbsent(StringRef key, const std::string &value) {
 
     if (key.size() + value.size() > _max_size) {
         return false;
     }
 
-    auto it = _lru_index.find(std::ref(key));
+    auto it = _lru_index.find(key);
     // not enought memory
     if (it != _lru_index.end()) {
         return false;
     }
     prepareLRU(key.size() + value.size());
-    addNode(key, value);
+    addNode(key, std::make_shared<const std::string>(value));
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) {
+bool SimpleLRU::Set(StringRef key, const std::string &value) {
 
     if (key.size() + value.size() > _max_size) {
         return false;
     }
 
-    auto it = _lru_index.find(std::ref(key));
+    auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
         return false;
     }
-    prepareLRU((int)value.size() - (int)it->second.get().value.size());
+    prepareLRU((int)value.size() - (int)it->second.get().value->size());
     moveNode(it);
-    _lru_head.get()->value = value;
+    _lru_head.get()->value = std::make_shared<const std::string>(value);
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Delete(const std::string &key) {
+bool SimpleLRU::Delete(StringRef key) {
 
-    auto it = _lru_index.find(std::ref(key));
+    auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
         return false;
 
@@ -84,15 +89,28 @@ bool SimpleLRU::Delete(const std::string &key) {
     }
 }
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) {
+bool SimpleLRU::Get(StringRef key, std::string &value) {
 
-    auto it = _lru_index.find(std::ref(key));
+    auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
         return false;
     }
 
     lru_node &finded_node = it->second.get();
-    value.assign(finded_node.value);
+    value.assign(*finded_node.value);
+    moveNode(it);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Get(StringRef key, std::shared_ptr<const std::string> &value) {
+
+    auto it = _lru_index.find(key);
+    if (it == _lru_index.end()) {
+        return false;
+    }
+
+    value = it->second.get().value;
     moveNode(it);
     return true;
 }
@@ -100,7 +118,7 @@ bool SimpleLRU::Get(const std::string &key, std::string &value) {
 void SimpleLRU::PrintStorage() {
     lru_node *tmp = _lru_head.get();
     while (tmp != nullptr) {
-        std::cout << tmp->key << " : " << tmp->value << std::endl;
+        std::cout << tmp->key << " : " << *tmp->value << std::endl;
         tmp = tmp->next.get();
     }
 }
@@ -117,10 +135,10 @@ bool SimpleLRU::prepareLRU(const int record_size) {
     return true;
 }
 
-size_t SimpleLRU::deleteNode(const std::map<string_wrapper, node_wrapper>::iterator &it) {
+size_t SimpleLRU::deleteNode(const lru_index::iterator &it) {
 
     lru_node &finded_node = it->second.get();
-    size_t node_size = finded_node.key.size() + finded_node.value.size();
+    size_t node_size = finded_node.key.size() + finded_node.value->size();
 
     // head deletion
     if (_lru_head.get() == &finded_node) {
@@ -149,7 +167,7 @@ size_t SimpleLRU::deleteNode(const std::map<string_wrapper, node_wrapper>::itera
     return node_size;
 }
 
-void SimpleLRU::moveNode(const std::map<string_wrapper, node_wrapper>::iterator &it) {
+void SimpleLRU::moveNode(const lru_index::iterator &it) {
 
     lru_node &finded_node = it->second.get();
 
@@ -174,9 +192,9 @@ void SimpleLRU::moveNode(const std::map<string_wrapper, node_wrapper>::iterator
     }
 }
 
-void SimpleLRU::addNode(const std::string &key, const std::string &value) {
+void SimpleLRU::addNode(StringRef key, std::shared_ptr<const std::string> value) {
 
-    std::unique_ptr<lru_node> new_head = std::unique_ptr<lru_node>(new lru_node(key, value));
+    std::unique_ptr<lru_node> new_head = std::unique_ptr<lru_node>(new lru_node(key, std::move(value)));
 
     if (_lru_head.get()) {
         new_head.get()->prev = _lru_head.get()->prev;
@@ -190,8 +208,7 @@ void SimpleLRU::addNode(const std::string &key, const std::string &value) {
 
     _lru_head.reset(new_head.release());
 
-    _lru_index.insert(
-        std::pair<string_wrapper, node_wrapper>(std::cref(_lru_head.get()->key), std::ref(*_lru_head.get())));
+    _lru_index.insert(std::make_pair(StringRef(_lru_head.get()->key), std::ref(*_lru_head.get())));
 }
 
 size_t SimpleLRU::freeTail(const int requared_size) {
@@ -199,8 +216,8 @@ size_t SimpleLRU::freeTail(const int requared_size) {
     size_t allocated_before = _allocated_memory;
     while (_max_size - _allocated_memory < requared_size) {
         lru_node *last = _lru_head.get()->prev;
-        size_t node_size = last->key.size() + last->value.size();
-        _lru_index.erase(std::cref(last->key));
+        size_t node_size = last->key.size() + last->value->size();
+        _lru_index.erase(StringRef(last->key));
 
         if (last == _lru_head.get()) {
             _lru_head.reset();
@@ -25,19 +25,25 @@ public:
 
     // Implements Afina::Storage interface
     // add const
-    bool Put(const std::string &key, const std::string &value) override;
+    bool Put(StringRef key, const std::string &value) override;
 
     // Implements Afina::Storage interface
-    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+    bool Put(StringRef key, std::string &&value) override;
 
     // Implements Afina::Storage interface
-    bool Set(const std::string &key, const std::string &value) override;
+    bool PutIfAbsent(StringRef key, const std::string &value) override;
 
     // Implements Afina::Storage interface
-    bool Delete(const std::string &key) override;
+    bool Set(StringRef key, const std::string &value) override;
 
     // Implements Afina::Storage interface
-    bool Get(const std::string &key, std::string &value) override;
+    bool Delete(StringRef key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(StringRef key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Get(StringRef key, std::shared_ptr<const std::string> &value) override;
 
     // Print all items in Storage
     void PrintStorage();
@@ -46,15 +52,22 @@ private:
     // LRU cache node
     using lru_node = struct lru_node {
         const std::string key;
-        std::string value;
+        // Value is never changed in place, new one replaces it. So whoever got the value could keep it after node
+        // is updated or deleted
+        std::shared_ptr<const std::string> value;
         lru_node *prev;
         std::unique_ptr<lru_node> next;
 
-        lru_node(const std::string &key, const std::string &value) : key(key), value(value){};
+        lru_node(StringRef key, std::shared_ptr<const std::string> value)
+            : key(key.data(), key.size()), value(std::move(value)){};
     };
 
-    using string_wrapper = std::reference_wrapper<const std::string>;
+    // Index key points to lru_node#key, so lookups by reference to the network buffer need no copy
     using node_wrapper = std::reference_wrapper<lru_node>;
+    using lru_index = std::map<StringRef, node_wrapper>;
+
+    // Shared by Put overloads, value gets either copied or moved into the node
+    template <typename Value> bool put(StringRef key, Value &&value);
 
     bool prepareLRU(const int record_size);
     // Function that free last elements;
@@ -62,10 +75,10 @@ private:
 
     std::size_t freeTail(const int req_mem);
     // Add node at head of list
-    void addNode(const std::string &key, const std::string &value);
+    void addNode(StringRef key, std::shared_ptr<const std::string> value);
     // move node to head
-    void moveNode(const std::map<string_wrapper, node_wrapper>::iterator &it);
-    std::size_t deleteNode(const std::map<string_wrapper, node_wrapper>::iterator &it);
+    void moveNode(const lru_index::iterator &it);
+    std::size_t deleteNode(const lru_index::iterator &it);
 
     //--------------------------------------------------------------
 
@@ -81,7 +94,7 @@ private:
     // List owns all nodes
     std::unique_ptr<lru_node> _lru_head;
     // Index of nodes from list above, allows fast random access to elements by lru_node#key
-    std::map<string_wrapper, node_wrapper, std::less<std::string>> _lru_index;
+    lru_index _lru_index;
 };
 
 } // namespace Backend
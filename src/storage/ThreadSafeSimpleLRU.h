@@ -1,6 +1,7 @@
 #ifndef AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 #define AFINA_STORAGE_THREAD_SAFE_SIMPLE_LRU_H
 
+#include <functional>
 #include <map>
 #include <mutex>
 #include <string>
@@ -21,38 +22,86 @@ public:
     ~ThreadSafeSimplLRU() {}
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override {
+    bool Put(StringRef key, const std::string &value) override {
         std::lock_guard<std::mutex> lock(_access_mutex);
         return SimpleLRU::Put(key, value);
     }
 
     // see SimpleLRU.h
-    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+    bool Put(StringRef key, std::string &&value) override {
+        std::lock_guard<std::mutex> lock(_access_mutex);
+        return SimpleLRU::Put(key, std::move(value));
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(StringRef key, const std::string &value) override {
         std::lock_guard<std::mutex> lock(_access_mutex);
         return SimpleLRU::PutIfAbsent(key, value);
 
     }
 
     // see SimpleLRU.h
-    bool Set(const std::string &key, const std::string &value) override {
+    bool Set(StringRef key, const std::string &value) override {
         std::lock_guard<std::mutex> lock(_access_mutex);
         return SimpleLRU::Set(key, value);
 
     }
 
     // see SimpleLRU.h
-    bool Delete(const std::string &key) override {
+    bool Delete(StringRef key) override {
             std::lock_guard<std::mutex> lock(_access_mutex);
             return SimpleLRU::Delete(key);
     }
 
     // see SimpleLRU.h
-    bool Get(const std::string &key, std::string &value) override {
+    bool Get(StringRef key, std::string &value) override {
         std::lock_guard<std::mutex> lock(_access_mutex);
         return SimpleLRU::Get(key, value);
     }
 
+    // see SimpleLRU.h
+    bool Get(StringRef key, std::shared_ptr<const std::string> &value) override {
+        std::lock_guard<std::mutex> lock(_access_mutex);
+        return SimpleLRU::Get(key, value);
+    }
+
+    // see Storage.h
+    void Batch(const std::function<void(Storage &)> &operations) override {
+        std::lock_guard<std::mutex> lock(_access_mutex);
+        Unlocked unlocked(*this);
+        operations(unlocked);
+    }
+
 private:
+    // View on the storage performing operations without locking, valid while _access_mutex is held
+    class Unlocked : public Storage {
+    public:
+        Unlocked(SimpleLRU &owner) : _owner(owner) {}
+
+        bool Put(StringRef key, const std::string &value) override { return _owner.SimpleLRU::Put(key, value); }
+
+        bool Put(StringRef key, std::string &&value) override {
+            return _owner.SimpleLRU::Put(key, std::move(value));
+        }
+
+        bool PutIfAbsent(StringRef key, const std::string &value) override {
+            return _owner.SimpleLRU::PutIfAbsent(key, value);
+        }
+
+        bool Set(StringRef key, const std::string &value) override { return _owner.SimpleLRU::Set(key, value); }
+
+        bool Delete(StringRef key) override { return _owner.SimpleLRU::Delete(key); }
+
+        bool Get(StringRef key, std::string &value) override { return _owner.SimpleLRU::Get(key, value); }
+
+        bool Get(StringRef key, std::shared_ptr<const std::string> &value) override {
+            return _owner.SimpleLRU::Get(key, value);
+        }
+
+    private:
+        SimpleLRU &_owner;
+    };
+
     std::mutex _access_mutex;
 };
 
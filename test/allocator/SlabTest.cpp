@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Slab.h>
+
+using namespace std;
+using namespace Afina::Allocator;
+
+static char slab_buf[1024 * 1024];
+
+TEST(SlabTest, AllocInRange) {
+    Slab a(slab_buf, sizeof(slab_buf));
+
+    for (size_t size : {1, 16, 17, 100, 1000, 40000}) {
+        char *v = static_cast<char *>(a.alloc(size));
+        EXPECT_GE(v, slab_buf);
+        EXPECT_LE(v + size, slab_buf + sizeof(slab_buf));
+        std::memset(v, 0xAA, size);
+        a.free(v);
+    }
+}
+
+TEST(SlabTest, NoOverlap) {
+    Slab a(slab_buf, sizeof(slab_buf));
+
+    vector<char *> ptrs;
+    for (int i = 0; i < 1000; i++) {
+        size_t size = 8 + (i * 37) % 500;
+        char *v = static_cast<char *>(a.alloc(size));
+        std::memset(v, i % 251, size);
+        ptrs.push_back(v);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        size_t size = 8 + (i * 37) % 500;
+        for (size_t j = 0; j < size; j++) {
+            ASSERT_EQ(char(i % 251), ptrs[i][j]);
+        }
+        a.free(ptrs[i]);
+    }
+}
+
+TEST(SlabTest, Reuse) {
+    Slab a(slab_buf, sizeof(slab_buf));
+
+    void *p = a.alloc(100);
+    a.free(p);
+    EXPECT_EQ(p, a.alloc(100));
+}
+
+// Factor close to 1 makes hundreds of classes, object freed must go back to its own class
+TEST(SlabTest, ManyClasses) {
+    Slab a(slab_buf, sizeof(slab_buf), 64 * 1024, 1.01);
+
+    for (size_t size : {5000, 12000, 20000, 30000}) {
+        void *p = a.alloc(size);
+        a.free(p);
+        EXPECT_EQ(p, a.alloc(size));
+    }
+}
+
+TEST(SlabTest, NoMemory) {
+    Slab a(slab_buf, 4 * 1024, 1024);
+
+    try {
+        a.alloc(2048);
+        EXPECT_TRUE(false);
+    } catch (AllocError &e) {
+        EXPECT_EQ(e.getType(), AllocErrorType::NoMemory);
+    }
+
+    try {
+        for (int i = 0; i < 5; i++) {
+            a.alloc(1024);
+        }
+        EXPECT_TRUE(false);
+    } catch (AllocError &e) {
+        EXPECT_EQ(e.getType(), AllocErrorType::NoMemory);
+    }
+}
+
+TEST(SlabTest, InvalidFree) {
+    Slab a(slab_buf, sizeof(slab_buf));
+
+    char other[16];
+    try {
+        a.free(other);
+        EXPECT_TRUE(false);
+    } catch (AllocError &e) {
+        EXPECT_EQ(e.getType(), AllocErrorType::InvalidFree);
+    }
+}
+
+TEST(SlabTest, CrossThreadFree) {
+    Slab a(slab_buf, sizeof(slab_buf));
+
+    vector<void *> ptrs;
+    for (int i = 0; i < 1000; i++) {
+        ptrs.push_back(a.alloc(64));
+    }
+
+    std::thread t([&a, &ptrs]() {
+        for (void *p : ptrs) {
+            a.free(p);
+        }
+    });
+    t.join();
+
+    set<void *> again;
+    for (int i = 0; i < 1000; i++) {
+        again.insert(a.alloc(64));
+    }
+    EXPECT_EQ(set<void *>(ptrs.begin(), ptrs.end()), again);
+}
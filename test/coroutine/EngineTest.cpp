@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include <afina/coroutine/Engine.h>
 
@@ -62,3 +63,96 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+void _waiter(Afina::Coroutine::Engine &pe, std::stringstream &out) {
+    out << "W1 ";
+    pe.block();
+    out << "W2 ";
+}
+
+void _blocker(Afina::Coroutine::Engine &pe, std::stringstream &out, void *&waiter) {
+    waiter = pe.run(_waiter, pe, out);
+    pe.sched(waiter);
+    out << "M ";
+}
+
+TEST(CoroutineTest, Unblocker) {
+    std::stringstream out;
+    void *waiter = nullptr;
+    int calls = 0;
+
+    // Engine runs out of routines ready to run once main is done and the waiter is blocked
+    Afina::Coroutine::Engine engine([&](Afina::Coroutine::Engine &pe) {
+        calls++;
+        out << "U ";
+        pe.unblock(waiter);
+    });
+    engine.start(_blocker, engine, out, waiter);
+
+    ASSERT_EQ(1, calls);
+    ASSERT_EQ("W1 M U W2 ", out.str());
+}
+
+TEST(CoroutineTest, BlockedAreDropped) {
+    std::stringstream out;
+    void *waiter = nullptr;
+
+    // Nobody is going to unblock the waiter
+    Afina::Coroutine::Engine engine;
+    engine.start(_blocker, engine, out, waiter);
+    ASSERT_EQ("W1 M ", out.str());
+}
+
+TEST(CoroutineTest, DedicatedSimpleStart) {
+    Afina::Coroutine::Engine engine(nullptr, Afina::Coroutine::Engine::Stacks::Dedicated);
+
+    int result;
+    engine.start(_calculator_add, result, 1, 2);
+
+    ASSERT_EQ(3, result);
+}
+
+TEST(CoroutineTest, DedicatedPrinter) {
+    Afina::Coroutine::Engine engine(nullptr, Afina::Coroutine::Engine::Stacks::Dedicated);
+
+    out.str("");
+    std::string result;
+    engine.start(_printer, engine, result);
+    ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
+}
+
+TEST(CoroutineTest, DedicatedUnblocker) {
+    std::stringstream out;
+    void *waiter = nullptr;
+    Afina::Coroutine::Engine engine(
+        [&](Afina::Coroutine::Engine &pe) {
+            out << "U ";
+            pe.unblock(waiter);
+        },
+        Afina::Coroutine::Engine::Stacks::Dedicated);
+    engine.start(_blocker, engine, out, waiter);
+    ASSERT_EQ("W1 M U W2 ", out.str());
+}
+
+void _square(Afina::Coroutine::Engine &pe, int &result, int value) {
+    pe.yield();
+    result = value * value;
+}
+
+void _spawner(Afina::Coroutine::Engine &pe, std::vector<int> &results) {
+    // Values passed to the routines are gone once spawner returns, routines keep copies of them
+    for (int i = 0; i < results.size(); i++) {
+        pe.run(_square, pe, results[i], int(i));
+    }
+}
+
+TEST(CoroutineTest, DedicatedArgumentsAreKept) {
+    Afina::Coroutine::Engine engine(nullptr, Afina::Coroutine::Engine::Stacks::Dedicated);
+
+    // More routines than stacks kept in the pool
+    std::vector<int> results(1000, -1);
+    engine.start(_spawner, engine, results);
+    for (int i = 0; i < results.size(); i++) {
+        ASSERT_EQ(i * i, results[i]);
+    }
+}
@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Scheduler.h>
+
+using Afina::Coroutine::Scheduler;
+
+void _count(Scheduler &scheduler, std::atomic<int> &counter, int yields) {
+    for (int i = 0; i < yields; i++) {
+        scheduler.yield();
+    }
+    counter++;
+}
+
+TEST(SchedulerTest, RunsAll) {
+    Scheduler scheduler(4);
+    std::atomic<int> counter(0);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(scheduler.run(_count, scheduler, counter, int(i % 8)));
+    }
+
+    scheduler.Start();
+    scheduler.Join();
+    ASSERT_EQ(1000, counter);
+}
+
+void _tree(Scheduler &scheduler, std::atomic<int> &counter, int depth) {
+    counter++;
+    if (depth > 0) {
+        scheduler.run(_tree, scheduler, counter, int(depth - 1));
+        scheduler.yield();
+        scheduler.run(_tree, scheduler, counter, int(depth - 1));
+    }
+}
+
+TEST(SchedulerTest, RoutinesStartRoutines) {
+    Scheduler scheduler(4);
+    std::atomic<int> counter(0);
+    scheduler.Start();
+    scheduler.run(_tree, scheduler, counter, 10);
+    scheduler.Join();
+    ASSERT_EQ(2047, counter);
+}
+
+void _spin(std::mutex &mutex, std::set<std::thread::id> &threads) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+}
+
+void _spawner(Scheduler &scheduler, std::mutex &mutex, std::set<std::thread::id> &threads) {
+    for (int i = 0; i < 64; i++) {
+        scheduler.run(_spin, mutex, threads);
+    }
+}
+
+TEST(SchedulerTest, IdleProcessorsSteal) {
+    Scheduler scheduler(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    // Every routine lands into the queue of the single processor
+    scheduler.Start();
+    scheduler.run(_spawner, scheduler, mutex, threads);
+    scheduler.Join();
+    ASSERT_GT(threads.size(), 1);
+}
+
+void _echo(Scheduler &scheduler, int fd, int rounds, std::atomic<int> &done) {
+    for (int i = 0; i < rounds; i++) {
+        char value;
+        while (read(fd, &value, 1) != 1) {
+            scheduler.wait(fd, EPOLLIN);
+        }
+        value++;
+        while (write(fd, &value, 1) != 1) {
+            scheduler.wait(fd, EPOLLOUT);
+        }
+    }
+    done++;
+}
+
+void _ping(Scheduler &scheduler, int fd, int rounds, std::atomic<int> &done) {
+    char value = 0;
+    for (int i = 0; i < rounds; i++) {
+        char sent = value;
+        while (write(fd, &sent, 1) != 1) {
+            scheduler.wait(fd, EPOLLOUT);
+        }
+        while (read(fd, &value, 1) != 1) {
+            scheduler.wait(fd, EPOLLIN);
+        }
+        if (value != char(sent + 1)) {
+            return;
+        }
+    }
+    done++;
+}
+
+TEST(SchedulerTest, WaitForDescriptors) {
+    Scheduler scheduler(4);
+    std::atomic<int> done(0);
+
+    const int pairs = 32, rounds = 200;
+    std::vector<int> sockets;
+    for (int i = 0; i < pairs; i++) {
+        int fds[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+        sockets.push_back(fds[0]);
+        sockets.push_back(fds[1]);
+        scheduler.run(_echo, scheduler, int(fds[0]), int(rounds), done);
+        scheduler.run(_ping, scheduler, int(fds[1]), int(rounds), done);
+    }
+
+    scheduler.Start();
+    scheduler.Join();
+    for (int fd : sockets) {
+        close(fd);
+    }
+    ASSERT_EQ(2 * pairs, done);
+}
+
+TEST(SchedulerTest, NotStartedDropsRoutines) {
+    std::atomic<int> counter(0);
+    {
+        Scheduler scheduler(2);
+        scheduler.run(_count, scheduler, counter, 0);
+    }
+    ASSERT_EQ(0, counter);
+}
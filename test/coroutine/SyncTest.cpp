@@ -0,0 +1,163 @@
+#include "gtest/gtest.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Sync.h>
+
+using namespace Afina::Coroutine;
+
+struct Shared {
+    Shared(Engine &engine) : engine(engine), mutex(engine), condition(engine), group(engine), ready(false), inside(0) {}
+
+    Engine &engine;
+    Mutex mutex;
+    CondVar condition;
+    WaitGroup group;
+    bool ready;
+    int inside;
+    std::vector<int> order;
+    std::vector<int> arrivals;
+};
+
+void _critical(Shared &shared, int id) {
+    shared.arrivals.push_back(id);
+    std::lock_guard<Mutex> lock(shared.mutex);
+    shared.inside++;
+    for (int i = 0; i < 3; i++) {
+        shared.engine.yield();
+        ASSERT_EQ(1, shared.inside);
+    }
+    shared.order.push_back(id);
+    shared.inside--;
+}
+
+void _lockers(Shared &shared) {
+    for (int id = 0; id < 4; id++) {
+        shared.engine.run(_critical, shared, int(id));
+    }
+}
+
+TEST(SyncTest, MutexIsHandedOverInOrder) {
+    Engine engine;
+    Shared shared(engine);
+    engine.start(_lockers, shared);
+
+    ASSERT_EQ(4, shared.order.size());
+    ASSERT_EQ(0, shared.inside);
+    ASSERT_EQ(shared.arrivals, shared.order);
+}
+
+void _consumer(Shared &shared) {
+    std::unique_lock<Mutex> lock(shared.mutex);
+    shared.condition.wait(shared.mutex, [&shared] { return shared.ready; });
+    shared.order.push_back(1);
+    lock.unlock();
+    shared.group.done();
+}
+
+void _producer(Shared &shared) {
+    for (int i = 0; i < 3; i++) {
+        shared.engine.yield();
+    }
+
+    std::lock_guard<Mutex> lock(shared.mutex);
+    shared.order.push_back(0);
+    shared.ready = true;
+    shared.condition.notify_all();
+}
+
+void _group(Shared &shared) {
+    for (int i = 0; i < 3; i++) {
+        shared.group.add();
+        shared.engine.run(_consumer, shared);
+    }
+    shared.engine.run(_producer, shared);
+
+    shared.group.wait();
+    shared.order.push_back(2);
+}
+
+TEST(SyncTest, CondVarAndWaitGroup) {
+    for (auto stacks : {Engine::Stacks::Copied, Engine::Stacks::Dedicated}) {
+        Engine engine(nullptr, stacks);
+        Shared shared(engine);
+        engine.start(_group, shared);
+        ASSERT_EQ(std::vector<int>({0, 1, 1, 1, 2}), shared.order);
+    }
+}
+
+void _send(Channel<std::string> &channel, int count) {
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(channel.send(std::to_string(i)));
+        ASSERT_LE(channel.size(), channel.capacity());
+    }
+    channel.close();
+    ASSERT_FALSE(channel.send("late"));
+}
+
+void _receive(Channel<std::string> &channel, std::vector<std::string> &received) {
+    std::string value;
+    while (channel.receive(value)) {
+        received.push_back(value);
+    }
+}
+
+void _pipe(Engine &engine, Channel<std::string> &channel, std::vector<std::string> &received) {
+    engine.run(_receive, channel, received);
+    engine.run(_send, channel, 100);
+}
+
+TEST(SyncTest, ChannelKeepsOrder) {
+    Engine engine;
+    Channel<std::string> channel(engine, 4);
+    std::vector<std::string> received;
+    engine.start(_pipe, engine, channel, received);
+
+    ASSERT_EQ(100, received.size());
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(std::to_string(i), received[i]);
+    }
+}
+
+void _intruder(Engine &engine, void *waiter) {
+    // Routine waiting for the lock must keep waiting
+    engine.unblock(waiter);
+    engine.yield();
+}
+
+void _waiter(Shared &shared) {
+    shared.mutex.lock();
+    shared.order.push_back(1);
+    shared.mutex.unlock();
+}
+
+void _owner(Shared &shared) {
+    shared.mutex.lock();
+    void *waiter = shared.engine.run(_waiter, shared);
+    shared.engine.yield();
+    shared.engine.run(_intruder, shared.engine, static_cast<void *>(waiter));
+    for (int i = 0; i < 3; i++) {
+        shared.engine.yield();
+    }
+
+    shared.order.push_back(0);
+    shared.mutex.unlock();
+}
+
+TEST(SyncTest, UnblockedByOthersKeepWaiting) {
+    Engine engine;
+    Shared shared(engine);
+    engine.start(_owner, shared);
+    ASSERT_EQ(std::vector<int>({0, 1}), shared.order);
+}
+
+TEST(SyncTest, WaitOutsideOfRoutine) {
+    Engine engine;
+    WaitQueue queue(engine);
+    ASSERT_THROW(queue.Wait(), std::runtime_error);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include <afina/execute/Output.h>
+
+using namespace Afina::Execute;
+
+TEST(OutputTest, CopiedBytesShareSegment) {
+    Output out;
+    ASSERT_TRUE(out.empty());
+
+    out.append("VALUE ");
+    out.append(std::string("foo"));
+    out.push_back(' ');
+    out.append(2, '0');
+    ASSERT_EQ(12, out.size());
+    ASSERT_EQ("VALUE foo 00", out.str());
+
+    struct iovec iov[4];
+    ASSERT_EQ(1, out.prepare(iov, 4));
+    ASSERT_EQ(12, iov[0].iov_len);
+}
+
+TEST(OutputTest, BigValueIsReferenced) {
+    std::shared_ptr<const std::string> value = std::make_shared<const std::string>(Output::MinReference, 'x');
+
+    Output out;
+    out.append("VALUE foo\r\n");
+    out.append(value);
+    out.append("\r\nEND\r\n");
+    ASSERT_EQ(2, value.use_count());
+
+    struct iovec iov[4];
+    ASSERT_EQ(3, out.prepare(iov, 4));
+    ASSERT_EQ(value->data(), iov[1].iov_base);
+
+    // Only first segments fit
+    ASSERT_EQ(2, out.prepare(iov, 2));
+
+    // Small values are copied
+    out.append(std::make_shared<const std::string>("small"));
+    ASSERT_EQ(3, out.prepare(iov, 4));
+    ASSERT_EQ("VALUE foo\r\n" + *value + "\r\nEND\r\nsmall", out.str());
+
+    out.clear();
+    ASSERT_EQ(1, value.use_count());
+}
+
+TEST(OutputTest, PartialConsume) {
+    std::shared_ptr<const std::string> value = std::make_shared<const std::string>(Output::MinReference, 'x');
+
+    Output out;
+    out.append("head");
+    out.append(value);
+    out.append("tail");
+
+    // Part of the first segment
+    out.consume(2);
+    ASSERT_EQ("ad" + *value + "tail", out.str());
+
+    // Rest of the first and part of the value
+    struct iovec iov[4];
+    out.consume(12);
+    ASSERT_EQ(2, out.prepare(iov, 4));
+    ASSERT_EQ(value->data() + 10, iov[0].iov_base);
+    ASSERT_EQ(value->size() - 10, iov[0].iov_len);
+
+    out.consume(value->size() - 10 + 4);
+    ASSERT_TRUE(out.empty());
+    ASSERT_EQ(0, out.prepare(iov, 4));
+    ASSERT_EQ(1, value.use_count());
+}
+
+TEST(OutputTest, SlowReader) {
+    std::shared_ptr<const std::string> value = std::make_shared<const std::string>(Output::MinReference, 'x');
+
+    // Output never gets empty, sent segments still go away
+    Output out;
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        std::string line = "line " + std::to_string(i);
+        out.append(line);
+        out.append(value);
+        expected += line + *value;
+
+        size_t sent = (i % 3 == 0) ? 1 : out.size() - 1;
+        expected.erase(0, sent);
+        out.consume(sent);
+        ASSERT_EQ(expected.size(), out.size());
+    }
+    ASSERT_EQ(expected, out.str());
+    ASSERT_LT(value.use_count(), 10);
+}
+
+TEST(OutputTest, CopySpansChunks) {
+    Output out;
+    std::string expected(Output::ChunkSize - 3, 'a');
+    out.append(expected);
+    out.append("0123456789");
+    expected += "0123456789";
+    ASSERT_EQ(expected, out.str());
+
+    // Bytes don't fit into the first chunk, so they continue in the next segment
+    struct iovec iov[4];
+    ASSERT_EQ(2, out.prepare(iov, 4));
+    ASSERT_EQ(Output::ChunkSize, iov[0].iov_len);
+    ASSERT_EQ(7, iov[1].iov_len);
+
+    out.consume(Output::ChunkSize + 3);
+    ASSERT_EQ("6789", out.str());
+}
+
+TEST(OutputTest, AppendKeepsBytesInPlace) {
+    Output out;
+    out.append("VALUE a 0 1\r\n");
+
+    struct iovec iov[4];
+    ASSERT_EQ(1, out.prepare(iov, 4));
+    const char *head = static_cast<const char *>(iov[0].iov_base);
+
+    // Neither appends nor partial sends move bytes already there
+    for (int i = 0; i < 1000; i++) {
+        out.append("x\r\nEND\r\n");
+    }
+    out.consume(6);
+    ASSERT_EQ(1, out.prepare(iov, 1));
+    ASSERT_EQ(head + 6, iov[0].iov_base);
+    ASSERT_EQ("a 0 1\r\n", std::string(head + 6, 7));
+}
+
+TEST(OutputTest, SlowReaderKeepsOrder) {
+    std::shared_ptr<const std::string> value = std::make_shared<const std::string>(Output::MinReference, 'v');
+
+    // Responses keep coming while the previous ones are sent piece by piece
+    Output out;
+    std::string expected, sent;
+    for (int i = 0; i < 1000; i++) {
+        std::string line = "VALUE k" + std::to_string(i) + "\r\n";
+        out.append(line);
+        out.append(value);
+        expected += line + *value;
+
+        struct iovec iov[1];
+        ASSERT_EQ(1, out.prepare(iov, 1));
+        size_t n = std::min<size_t>(iov[0].iov_len, 300);
+        sent.append(static_cast<const char *>(iov[0].iov_base), n);
+        out.consume(n);
+    }
+    ASSERT_EQ(expected, sent + out.str());
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <network/Input.h>
+
+using namespace Afina::Network;
+
+namespace {
+
+// Reads bytes into the input the way connection does
+void Read(Input &input, const std::string &data) {
+    size_t room_size = 0;
+    char *room = input.room(room_size);
+    ASSERT_LE(data.size(), room_size);
+    std::memcpy(room, data.data(), data.size());
+    input.filled(data.size());
+}
+
+} // namespace
+
+TEST(InputTest, ConsumeAdvancesInPlace) {
+    Input input;
+    ASSERT_TRUE(input.empty());
+
+    Read(input, "get a\r\nget b\r\nge");
+    const char *first = input.data();
+    input.consume(7);
+    ASSERT_EQ(first + 7, input.data());
+    ASSERT_EQ("get b\r\nge", std::string(input.data(), input.size()));
+
+    // Tail of the partial command stays where it is while there is room
+    input.consume(7);
+    Read(input, "t c\r\n");
+    ASSERT_EQ(first + 14, input.data());
+    ASSERT_EQ("get c\r\n", std::string(input.data(), input.size()));
+
+    // Drained input starts over
+    input.consume(input.size());
+    ASSERT_TRUE(input.empty());
+    Read(input, "x");
+    ASSERT_EQ(first, input.data());
+}
+
+TEST(InputTest, CompactsWhenRoomIsLow) {
+    Input input;
+    Read(input, std::string(Input::InitialSize - Input::MinRoom / 2, 'a'));
+    input.consume(Input::InitialSize - Input::MinRoom);
+
+    // Unconsumed bytes are moved to the beginning instead of growing
+    size_t room_size = 0;
+    input.room(room_size);
+    ASSERT_EQ(Input::InitialSize - Input::MinRoom / 2, room_size);
+    ASSERT_EQ(std::string(Input::MinRoom / 2, 'a'), std::string(input.data(), input.size()));
+}
+
+TEST(InputTest, GrowsForBigRequest) {
+    Input input;
+    std::string request(3 * Input::InitialSize, 'r');
+    input.append(request.data(), request.size());
+    ASSERT_EQ(request, std::string(input.data(), input.size()));
+
+    // Memory is given back once request is processed
+    input.consume(input.size());
+    size_t room_size = 0;
+    input.room(room_size);
+    ASSERT_EQ(Input::InitialSize, room_size);
+}
+
+TEST(InputTest, RejectsTooBigRequest) {
+    Input input;
+    std::string request(Input::MaxSize, 'r');
+    input.append(request.data(), request.size());
+
+    size_t room_size = 0;
+    ASSERT_THROW(input.room(room_size), std::runtime_error);
+    ASSERT_THROW(input.append("x", 1), std::runtime_error);
+}
+
+TEST(InputTest, ReleasesDrainedBuffer) {
+    Input input;
+    Read(input, "get a\r\nge");
+    const char *buffer = input.data();
+
+    // Partial request keeps the buffer
+    input.consume(7);
+    input.release();
+    ASSERT_EQ(Input::InitialSize, input.capacity());
+
+    input.consume(input.size());
+    input.release();
+    ASSERT_EQ(0, input.capacity());
+
+    // Released buffer is the first one to be borrowed again
+    Read(input, "x");
+    ASSERT_EQ(buffer, input.data());
+}
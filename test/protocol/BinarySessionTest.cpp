@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <protocol/BinarySession.h>
+#include <protocol/Session.h>
+#include <storage/SimpleLRU.h>
+#include <storage/ThreadSafeSimpleLRU.h>
+
+using namespace Afina;
+using Protocol::BinarySession;
+
+namespace {
+
+// Builds request packet
+std::string Request(uint8_t opcode, const std::string &key, const std::string &value = "", bool extras = false,
+                    uint32_t opaque = 0) {
+    std::string extras_bytes = extras ? std::string(8, '\0') : std::string();
+    uint32_t body = extras_bytes.size() + key.size() + value.size();
+
+    std::string packet;
+    packet.push_back(char(BinarySession::RequestMagic));
+    packet.push_back(char(opcode));
+    packet.push_back(char(key.size() >> 8));
+    packet.push_back(char(key.size()));
+    packet.push_back(char(extras_bytes.size()));
+    packet.append(3, '\0');
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        packet.push_back(char(body >> shift));
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        packet.push_back(char(opaque >> shift));
+    }
+    packet.append(8, '\0');
+    return packet + extras_bytes + key + value;
+}
+
+// Parsed response packet
+struct Response {
+    uint8_t opcode;
+    uint16_t status;
+    uint32_t opaque;
+    std::string extras, key, value;
+};
+
+// Splits output into responses
+std::vector<Response> Responses(const std::string &out) {
+    std::vector<Response> result;
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(out.data());
+    size_t pos = 0;
+    while (pos + BinarySession::HeaderSize <= out.size()) {
+        const uint8_t *h = p + pos;
+        EXPECT_EQ(BinarySession::ResponseMagic, h[0]);
+
+        Response r;
+        r.opcode = h[1];
+        size_t key_size = (h[2] << 8) | h[3];
+        size_t extras_size = h[4];
+        r.status = (h[6] << 8) | h[7];
+        size_t body_size = (uint32_t(h[8]) << 24) | (h[9] << 16) | (h[10] << 8) | h[11];
+        r.opaque = (uint32_t(h[12]) << 24) | (h[13] << 16) | (h[14] << 8) | h[15];
+
+        const char *body = out.data() + pos + BinarySession::HeaderSize;
+        r.extras.assign(body, extras_size);
+        r.key.assign(body + extras_size, key_size);
+        r.value.assign(body + extras_size + key_size, body_size - extras_size - key_size);
+        result.push_back(r);
+
+        pos += BinarySession::HeaderSize + body_size;
+    }
+    EXPECT_EQ(out.size(), pos);
+    return result;
+}
+
+} // namespace
+
+TEST(BinarySessionTest, Detect) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    std::unique_ptr<Protocol::Session> binary = Protocol::Session::Detect(char(0x80), storage);
+    ASSERT_TRUE(dynamic_cast<BinarySession *>(binary.get()) != nullptr);
+
+    std::unique_ptr<Protocol::Session> text = Protocol::Session::Detect('g', storage);
+    ASSERT_TRUE(dynamic_cast<BinarySession *>(text.get()) == nullptr);
+}
+
+TEST(BinarySessionTest, SetGet) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    BinarySession session(storage);
+
+    Execute::Output out;
+    const std::string input = Request(BinarySession::opSet, "foo", "fooval", true, 7) +
+                              Request(BinarySession::opGet, "foo", "", false, 8) +
+                              Request(BinarySession::opGetK, "foo", "", false, 9) +
+                              Request(BinarySession::opGet, "bar", "", false, 10);
+    ASSERT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+
+    std::vector<Response> r = Responses(out.str());
+    ASSERT_EQ(4, r.size());
+
+    ASSERT_EQ(BinarySession::opSet, r[0].opcode);
+    ASSERT_EQ(BinarySession::stOk, r[0].status);
+    ASSERT_EQ(7, r[0].opaque);
+
+    ASSERT_EQ(BinarySession::stOk, r[1].status);
+    ASSERT_EQ(8, r[1].opaque);
+    ASSERT_EQ(4, r[1].extras.size());
+    ASSERT_EQ("", r[1].key);
+    ASSERT_EQ("fooval", r[1].value);
+
+    ASSERT_EQ(9, r[2].opaque);
+    ASSERT_EQ("foo", r[2].key);
+    ASSERT_EQ("fooval", r[2].value);
+
+    ASSERT_EQ(BinarySession::stKeyNotFound, r[3].status);
+    ASSERT_EQ(10, r[3].opaque);
+}
+
+// Pipelined multi-get: quiet gets answer only hits, noop finishes the batch
+TEST(BinarySessionTest, QuietMultiGet) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("a", "1");
+    storage->Put("c", "3");
+    BinarySession session(storage);
+
+    Execute::Output out;
+    const std::string input = Request(BinarySession::opGetKQ, "a", "", false, 1) +
+                              Request(BinarySession::opGetKQ, "b", "", false, 2) +
+                              Request(BinarySession::opGetKQ, "c", "", false, 3) +
+                              Request(BinarySession::opSetQ, "d", "4", true, 4) +
+                              Request(BinarySession::opNoop, "", "", false, 5);
+    session.Process(input.data(), input.size(), out);
+
+    std::vector<Response> r = Responses(out.str());
+    ASSERT_EQ(3, r.size());
+    ASSERT_EQ("a", r[0].key);
+    ASSERT_EQ("1", r[0].value);
+    ASSERT_EQ("c", r[1].key);
+    ASSERT_EQ("3", r[1].value);
+    ASSERT_EQ(BinarySession::opNoop, r[2].opcode);
+    ASSERT_EQ(5, r[2].opaque);
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("d", value));
+    ASSERT_EQ("4", value);
+}
+
+// Packets splitted at any byte are assembled back
+TEST(BinarySessionTest, Chunked) {
+    const std::string input = Request(BinarySession::opSet, "key", std::string(100, 'v'), true, 1) +
+                              Request(BinarySession::opGetK, "key", "", false, 2);
+
+    for (size_t chunk = 1; chunk <= input.size(); chunk++) {
+        std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+        BinarySession session(storage);
+
+        Execute::Output out;
+        for (size_t pos = 0; pos < input.size(); pos += chunk) {
+            size_t len = std::min(chunk, input.size() - pos);
+            ASSERT_EQ(len, session.Process(input.data() + pos, len, out));
+        }
+
+        std::vector<Response> r = Responses(out.str());
+        ASSERT_EQ(2, r.size());
+        ASSERT_EQ(BinarySession::stOk, r[0].status);
+        ASSERT_EQ(std::string(100, 'v'), r[1].value);
+    }
+}
+
+TEST(BinarySessionTest, Errors) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("foo", "bar");
+    BinarySession session(storage);
+
+    Execute::Output out;
+    const std::string input = Request(BinarySession::opAddQ, "foo", "x", true) +
+                              Request(BinarySession::opReplace, "nope", "x", true) +
+                              Request(BinarySession::opSet, "foo", "x", false) + Request(0x55, "foo");
+    session.Process(input.data(), input.size(), out);
+
+    std::vector<Response> r = Responses(out.str());
+    ASSERT_EQ(4, r.size());
+    ASSERT_EQ(BinarySession::stKeyExists, r[0].status);
+    ASSERT_EQ(BinarySession::stKeyNotFound, r[1].status);
+    ASSERT_EQ(BinarySession::stInvalidArguments, r[2].status);
+    ASSERT_EQ(BinarySession::stUnknownCommand, r[3].status);
+
+    std::string garbage(BinarySession::HeaderSize, 'x');
+    ASSERT_THROW(session.Process(garbage.data(), garbage.size(), out), std::runtime_error);
+}
+
+// Body over the limit is refused once header arrives and dropped without being buffered
+TEST(BinarySessionTest, TooLarge) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    const std::string input = Request(BinarySession::opSet, "big", std::string(2 * 1024 * 1024, 'v'), true, 1) +
+                              Request(BinarySession::opGetK, "big", "", false, 2) + Request(BinarySession::opNoop, "");
+
+    for (size_t chunk : {size_t(10), size_t(4096), input.size()}) {
+        BinarySession session(storage);
+        Execute::Output out;
+        for (size_t pos = 0; pos < input.size(); pos += chunk) {
+            size_t len = std::min(chunk, input.size() - pos);
+            ASSERT_EQ(len, session.Process(input.data() + pos, len, out));
+        }
+
+        std::vector<Response> r = Responses(out.str());
+        ASSERT_EQ(3, r.size());
+        ASSERT_EQ(BinarySession::stValueTooLarge, r[0].status);
+        ASSERT_EQ(1, r[0].opaque);
+        ASSERT_EQ(BinarySession::stKeyNotFound, r[1].status);
+        ASSERT_EQ(BinarySession::opNoop, r[2].opcode);
+    }
+}
+
+// Clients of the different threads appending to the same key don't lose appends
+TEST(BinarySessionTest, ConcurrentAppend) {
+    std::shared_ptr<Storage> storage(new Backend::ThreadSafeSimplLRU(64 * 1024));
+    storage->Put("key", "");
+
+    const std::string input = Request(BinarySession::opAppendQ, "key", "x");
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 4; i++) {
+        clients.emplace_back([storage, &input]() {
+            BinarySession session(storage);
+            Execute::Output out;
+            for (int j = 0; j < 500; j++) {
+                session.Process(input.data(), input.size(), out);
+            }
+            EXPECT_TRUE(out.empty());
+        });
+    }
+    for (auto &client : clients) {
+        client.join();
+    }
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("key", value));
+    ASSERT_EQ(2000, value.size());
+}
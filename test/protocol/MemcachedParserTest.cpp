@@ -1,14 +1,13 @@
 #include <gtest/gtest.h>
 
-#include <memory>
+#include <algorithm>
 #include <string>
 
-#include <afina/execute/Add.h>
-#include <afina/execute/Get.h>
-#include <afina/execute/Set.h>
-#include <afina/execute/Stats.h>
+#include <afina/execute/AnyCommand.h>
 
 #include <protocol/Parser.h>
+#include <protocol/Commands.h>
+#include <protocol/Scanner.h>
 
 using namespace Afina;
 
@@ -21,17 +20,18 @@ TEST(MemcachedParserTest, SimpleSet) {
     Protocol::Parser parser;
 
     size_t consumed = 0;
-    bool cmd_avail = parser.Parse("set foo 0 0 6\r\nfooval\r\n", consumed);
+    const std::string input = "set foo 0 0 6\r\nfooval\r\n";
+    bool cmd_avail = parser.Parse(input, consumed);
     ASSERT_TRUE(cmd_avail);
     ASSERT_EQ(15, consumed);
     ASSERT_EQ("set", parser.Name());
 
     size_t value_size;
-    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
-    ASSERT_FALSE(cmd == nullptr);
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
     ASSERT_EQ(6, value_size);
 
-    Execute::Set *tmp = reinterpret_cast<Execute::Set *>(cmd.get());
+    Execute::Set *tmp = cmd.get<Execute::Set>();
     ASSERT_EQ("foo", tmp->key());
     ASSERT_EQ(0, tmp->flags());
     ASSERT_EQ(0, tmp->expire());
@@ -42,17 +42,18 @@ TEST(MemcachedParserTest, SimpleAdd) {
     Protocol::Parser parser;
 
     size_t consumed = 0;
-    bool cmd_avail = parser.Parse("add bar 10 -1 60\r\nbarval\r\n", consumed);
+    const std::string input = "add bar 10 -1 60\r\nbarval\r\n";
+    bool cmd_avail = parser.Parse(input, consumed);
     ASSERT_TRUE(cmd_avail);
     ASSERT_EQ(18, consumed);
     ASSERT_EQ("add", parser.Name());
 
     size_t value_size;
-    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
-    ASSERT_FALSE(cmd == nullptr);
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
     ASSERT_EQ(60, value_size);
 
-    Execute::Add *tmp = reinterpret_cast<Execute::Add *>(cmd.get());
+    Execute::Add *tmp = cmd.get<Execute::Add>();
     ASSERT_EQ("bar", tmp->key());
     ASSERT_EQ(10, tmp->flags());
     ASSERT_EQ(-1, tmp->expire());
@@ -63,18 +64,19 @@ TEST(MemcachedParserTest, SimpleGet) {
     Protocol::Parser parser;
 
     size_t consumed = 0;
-    bool cmd_avail = parser.Parse("get ke key2 super_long_key\r\n", consumed);
+    const std::string input = "get ke key2 super_long_key\r\n";
+    bool cmd_avail = parser.Parse(input, consumed);
     ASSERT_TRUE(cmd_avail);
     ASSERT_EQ(28, consumed);
     ASSERT_EQ("get", parser.Name());
 
     size_t value_size;
-    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
-    ASSERT_FALSE(cmd == nullptr);
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
     ASSERT_EQ(0, value_size);
 
-    Execute::Get *tmp = reinterpret_cast<Execute::Get *>(cmd.get());
-    std::vector<std::string> keys = tmp->keys();
+    Execute::Get *tmp = cmd.get<Execute::Get>();
+    std::vector<StringRef> keys(tmp->keys(), tmp->keys() + tmp->count());
     ASSERT_EQ(3, keys.size());
     ASSERT_EQ("ke", keys[0]);
     ASSERT_EQ("key2", keys[1]);
@@ -85,16 +87,271 @@ TEST(MemcachedParserTest, Stats) {
     Protocol::Parser parser;
 
     size_t consumed = 0;
-    bool cmd_avail = parser.Parse("stats\r\n", consumed);
+    const std::string input = "stats\r\n";
+    bool cmd_avail = parser.Parse(input, consumed);
     ASSERT_TRUE(cmd_avail);
     ASSERT_EQ(7, consumed);
     ASSERT_EQ("stats", parser.Name());
 
     size_t value_size;
-    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
-    ASSERT_FALSE(cmd == nullptr);
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
     ASSERT_EQ(0, value_size);
 
-    Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
+    Execute::Stats *tmp = cmd.get<Execute::Stats>();
     ASSERT_FALSE(tmp == nullptr);
 }
+
+// Vectorized delimiter search must agree with byte by byte one for any position of delimiter
+TEST(MemcachedParserTest, ScannerMatchesScalar) {
+    std::string input(100, 'x');
+    for (size_t len = 0; len <= input.size(); len++) {
+        for (char delimiter : {' ', '\r'}) {
+            for (size_t at = 0; at <= len; at++) {
+                std::string buffer = input.substr(0, len);
+                if (at < len) {
+                    buffer[at] = delimiter;
+                }
+
+                const char *begin = buffer.data(), *end = buffer.data() + len;
+                ASSERT_EQ(Protocol::FindDelimiterScalar(begin, end), Protocol::FindDelimiter(begin, end));
+            }
+        }
+    }
+}
+
+// Parser must produce same result regardless of how input is split into chunks
+TEST(MemcachedParserTest, ChunkedGet) {
+    const std::string input = "get short a_very_long_key_which_doesnt_fit_into_single_register "
+                              "another_pretty_long_key_0123456789abcdef\r\n";
+
+    for (size_t chunk = 1; chunk <= input.size(); chunk++) {
+        Protocol::Parser parser;
+
+        // Every chunk overwrites the previous one, as network reads do
+        std::string buffer;
+        size_t total = 0;
+        bool cmd_avail = false;
+        while (!cmd_avail && total < input.size()) {
+            size_t consumed = 0;
+            size_t len = std::min(chunk, input.size() - total);
+            buffer.assign(input, total, len);
+            cmd_avail = parser.Parse(&buffer[0], len, consumed);
+            total += consumed;
+        }
+        ASSERT_TRUE(cmd_avail);
+        ASSERT_EQ(input.size(), total);
+
+        size_t value_size;
+        Execute::AnyCommand cmd;
+        ASSERT_TRUE(parser.Build(cmd, value_size));
+
+        Execute::Get *tmp = cmd.get<Execute::Get>();
+        std::vector<StringRef> keys(tmp->keys(), tmp->keys() + tmp->count());
+        ASSERT_EQ(3, keys.size());
+        ASSERT_EQ("short", keys[0]);
+        ASSERT_EQ("a_very_long_key_which_doesnt_fit_into_single_register", keys[1]);
+        ASSERT_EQ("another_pretty_long_key_0123456789abcdef", keys[2]);
+    }
+}
+
+// Same for storage command, which key runs till the space
+TEST(MemcachedParserTest, ChunkedSet) {
+    const std::string input = "set a_long_key_for_the_set_command_to_cross_register 1 0 3\r\n";
+
+    for (size_t chunk = 1; chunk <= input.size(); chunk++) {
+        Protocol::Parser parser;
+
+        size_t total = 0;
+        bool cmd_avail = false;
+        while (!cmd_avail && total < input.size()) {
+            size_t consumed = 0;
+            size_t len = std::min(chunk, input.size() - total);
+            cmd_avail = parser.Parse(input.data() + total, len, consumed);
+            total += consumed;
+        }
+        ASSERT_TRUE(cmd_avail);
+        ASSERT_EQ(input.size(), total);
+
+        size_t value_size;
+        Execute::AnyCommand cmd;
+        ASSERT_TRUE(parser.Build(cmd, value_size));
+        ASSERT_EQ(3, value_size);
+
+        Execute::Set *tmp = cmd.get<Execute::Set>();
+        ASSERT_EQ("a_long_key_for_the_set_command_to_cross_register", tmp->key());
+        ASSERT_EQ(1, tmp->flags());
+    }
+}
+
+// Keys of get command reference parser input rather than copies
+TEST(MemcachedParserTest, GetKeysReferenceInput) {
+    Protocol::Parser parser;
+
+    const std::string input = "get foo bar\r\n";
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input, consumed));
+
+    size_t value_size;
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+
+    Execute::Get *tmp = cmd.get<Execute::Get>();
+    ASSERT_EQ(2, tmp->count());
+    ASSERT_EQ(input.data() + 4, tmp->keys()[0].data());
+    ASSERT_EQ(input.data() + 8, tmp->keys()[1].data());
+}
+
+// Key of storage command must survive input reuse, as body arrives later
+TEST(MemcachedParserTest, SetKeyOutlivesInput) {
+    Protocol::Parser parser;
+
+    std::string input = "set foo 0 0 6\r\n";
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input, consumed));
+
+    size_t value_size;
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+
+    input.assign(input.size(), 'x');
+    Execute::Set *tmp = cmd.get<Execute::Set>();
+    ASSERT_EQ("foo", tmp->key());
+}
+
+// Command names are recognized exactly, names sharing prefix with known ones are not
+TEST(MemcachedParserTest, LookupCommand) {
+    using Protocol::CommandId;
+    using Protocol::LookupCommand;
+
+    ASSERT_EQ(CommandId::Set, LookupCommand("set", 3));
+    ASSERT_EQ(CommandId::Add, LookupCommand("add", 3));
+    ASSERT_EQ(CommandId::Append, LookupCommand("append", 6));
+    ASSERT_EQ(CommandId::Prepend, LookupCommand("prepend", 7));
+    ASSERT_EQ(CommandId::Get, LookupCommand("get", 3));
+    ASSERT_EQ(CommandId::Gets, LookupCommand("gets", 4));
+    ASSERT_EQ(CommandId::Stats, LookupCommand("stats", 5));
+
+    ASSERT_EQ(CommandId::Unknown, LookupCommand("", 0));
+    ASSERT_EQ(CommandId::Unknown, LookupCommand("se", 2));
+    ASSERT_EQ(CommandId::Unknown, LookupCommand("sets", 4));
+    ASSERT_EQ(CommandId::Unknown, LookupCommand("SET", 3));
+}
+
+// Command place is reused between commands of different types
+TEST(MemcachedParserTest, ReuseCommand) {
+    Protocol::Parser parser;
+    Execute::AnyCommand cmd;
+    size_t consumed = 0, value_size = 0;
+
+    const std::string set = "set foo 0 0 6\r\n";
+    ASSERT_TRUE(parser.Parse(set, consumed));
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+    ASSERT_EQ(Execute::AnyCommand::Type::Set, cmd.type());
+    ASSERT_TRUE(cmd.get<Execute::Get>() == nullptr);
+    parser.Reset();
+
+    const std::string get = "get foo\r\n";
+    ASSERT_TRUE(parser.Parse(get, consumed));
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+    ASSERT_EQ(Execute::AnyCommand::Type::Get, cmd.type());
+    ASSERT_TRUE(cmd.get<Execute::Set>() == nullptr);
+    ASSERT_EQ("foo", cmd.get<Execute::Get>()->keys()[0]);
+
+    cmd.reset();
+    ASSERT_FALSE(cmd);
+}
+
+TEST(MemcachedParserTest, NoReply) {
+    Protocol::Parser parser;
+    size_t consumed = 0, value_size = 0;
+
+    const std::string input = "set foo 0 0 6 noreply\r\n";
+    ASSERT_TRUE(parser.Parse(input, consumed));
+    ASSERT_EQ(input.size(), consumed);
+    ASSERT_TRUE(parser.NoReply());
+
+    Execute::AnyCommand cmd;
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+    ASSERT_EQ(6, value_size);
+    ASSERT_EQ("foo", cmd.get<Execute::Set>()->key());
+
+    parser.Reset();
+    ASSERT_FALSE(parser.NoReply());
+
+    const std::string trailing = "set foo 0 0 6 \r\n";
+    ASSERT_TRUE(parser.Parse(trailing, consumed));
+    ASSERT_FALSE(parser.NoReply());
+
+    parser.Reset();
+    const std::string garbage = "set foo 0 0 6 noreplyx\r\n";
+    ASSERT_TRUE(parser.Parse(garbage, consumed));
+    ASSERT_STREQ("CLIENT_ERROR noreply expected", parser.Error());
+    ASSERT_FALSE(parser.Build(cmd, value_size));
+}
+
+TEST(MemcachedParserTest, Malformed) {
+    Protocol::Parser parser;
+    Execute::AnyCommand cmd;
+    size_t consumed = 0, value_size = 0;
+
+    // Rest of the malformed line is consumed, even if it comes in chunks
+    const std::string unknown = "bogus 1 2";
+    ASSERT_FALSE(parser.Parse(unknown, consumed));
+    ASSERT_EQ(unknown.size(), consumed);
+
+    const std::string rest = " 3\r\nget foo\r\n";
+    ASSERT_TRUE(parser.Parse(rest, consumed));
+    ASSERT_EQ(4, consumed);
+    ASSERT_STREQ("ERROR", parser.Error());
+    ASSERT_FALSE(parser.Build(cmd, value_size));
+
+    // Next line is a new command
+    parser.Reset();
+    ASSERT_EQ(nullptr, parser.Error());
+    const std::string next = rest.substr(4);
+    ASSERT_TRUE(parser.Parse(next, consumed));
+    ASSERT_TRUE(parser.Build(cmd, value_size));
+
+    parser.Reset();
+    const std::string long_key = "get " + std::string(251, 'k') + "\r\n";
+    ASSERT_TRUE(parser.Parse(long_key, consumed));
+    ASSERT_STREQ("CLIENT_ERROR key too long", parser.Error());
+
+    parser.Reset();
+    const std::string no_key = "get\r\n";
+    ASSERT_TRUE(parser.Parse(no_key, consumed));
+    ASSERT_STREQ("CLIENT_ERROR bad command line format", parser.Error());
+
+    parser.Reset();
+    const std::string overflow = "set foo 0 0 99999999999\r\n";
+    ASSERT_TRUE(parser.Parse(overflow, consumed));
+    ASSERT_STREQ("CLIENT_ERROR numeric field overflow", parser.Error());
+}
+
+TEST(MemcachedParserTest, MalformedLineEnd) {
+    Protocol::Parser parser;
+    size_t consumed = 0;
+
+    // Bare \n ends the malformed line, line after it is parsed
+    const std::string name = "bogus\nget foo\r\n";
+    ASSERT_TRUE(parser.Parse(name, consumed));
+    ASSERT_EQ(6, consumed);
+    ASSERT_STREQ("ERROR", parser.Error());
+
+    // Too long key fails at the first byte over the limit, whether key is splitted or not, so both drop the line
+    // up to the same \n
+    const std::string long_key = "get " + std::string(251, 'k') + "\nget foo\r\n";
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse(long_key, consumed));
+    ASSERT_EQ(256, consumed);
+    ASSERT_STREQ("CLIENT_ERROR key too long", parser.Error());
+
+    parser.Reset();
+    const std::string head = long_key.substr(0, 100);
+    const std::string tail = long_key.substr(100);
+    ASSERT_FALSE(parser.Parse(head, consumed));
+    ASSERT_TRUE(parser.Parse(tail, consumed));
+    ASSERT_EQ(156, consumed);
+    ASSERT_STREQ("CLIENT_ERROR key too long", parser.Error());
+}
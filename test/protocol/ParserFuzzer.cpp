@@ -0,0 +1,201 @@
+/**
+ * # Text protocol fuzzer
+ * libFuzzer compatible harness: input is fed into the text session twice, once as a whole and once splitted at
+ * random chunk boundaries, the way it could arrive from the network. Data blocks of the second run sometimes go
+ * through the direct buffer. Both runs must consume everything and respond the same, any difference means parser
+ * state is lost or broken between chunks.
+ *
+ * First two bytes of the input seed chunk boundaries, so fuzzer controls them as well.
+ *
+ * Built with -DAFINA_LIBFUZZER=ON under clang harness is linked with libFuzzer. Otherwise it has own driver: it
+ * replays files given in the command line or runs given number of random inputs, assembled from pieces of valid
+ * and broken commands. Driver prints offending input and aborts on failure.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <protocol/TextSession.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+// Storage big enough to keep everything fuzzer sets, so eviction doesn't hide differences
+constexpr size_t StorageSize = 16 * 1024 * 1024;
+
+void Fail(const char *reason, const std::string &input) {
+    std::cerr << "Fuzzer: " << reason << " on input of " << input.size() << " bytes:" << std::endl;
+    std::cerr.write(input.data(), input.size());
+    std::cerr << std::endl;
+    std::abort();
+}
+
+// Runs whole input through the new session
+std::string Whole(const std::string &input) {
+    Protocol::TextSession session(std::make_shared<Backend::SimpleLRU>(StorageSize));
+    Execute::Output out;
+    if (session.Process(input.data(), input.size(), out) != input.size()) {
+        Fail("input isn't consumed", input);
+    }
+    return out.str();
+}
+
+// Runs input through the new session by random chunks
+std::string Chunked(const std::string &input, uint32_t seed) {
+    std::minstd_rand rnd(seed);
+    Protocol::TextSession session(std::make_shared<Backend::SimpleLRU>(StorageSize));
+    Execute::Output out;
+
+    // Chunk is read into the buffer which is overwritten afterwards, as network does, so that session referencing
+    // consumed bytes gets garbage
+    std::string buffer;
+    size_t pos = 0;
+    while (pos < input.size()) {
+        // Mostly tiny chunks, they split tokens the most
+        size_t chunk = 1 + rnd() % ((rnd() % 4 == 0) ? 256 : 8);
+        chunk = std::min(chunk, input.size() - pos);
+
+        size_t direct_size = 0;
+        char *direct = session.DirectBuffer(direct_size);
+        if (direct != nullptr && rnd() % 2 == 0) {
+            chunk = std::min(chunk, direct_size);
+            std::memcpy(direct, input.data() + pos, chunk);
+            session.DirectFilled(chunk, out);
+        } else {
+            buffer.assign(input, pos, chunk);
+            if (session.Process(&buffer[0], chunk, out) != chunk) {
+                Fail("chunk isn't consumed", input);
+            }
+            buffer.assign(buffer.size(), '\xff');
+        }
+        pos += chunk;
+    }
+    return out.str();
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+
+    uint32_t seed = data[0] | (uint32_t(data[1]) << 8);
+    std::string input(reinterpret_cast<const char *>(data) + 2, size - 2);
+    std::string whole = Whole(input), chunked = Chunked(input, seed);
+    if (whole != chunked) {
+        std::cerr << "Fuzzer: whole input response:" << std::endl << whole << std::endl;
+        std::cerr << "Fuzzer: chunked input response:" << std::endl << chunked << std::endl;
+        Fail("chunked input gets different response", input);
+    }
+    return 0;
+}
+
+#ifndef AFINA_LIBFUZZER
+namespace {
+
+// Pieces random inputs are made of
+const char *const Pieces[] = {"get a\r\n",
+                              "get a b c\r\n",
+                              "gets a\r\n",
+                              "set a 0 0 5\r\nhello\r\n",
+                              "set b 1 2 3 noreply\r\nabc\r\n",
+                              "add a 0 0 1\r\nx\r\n",
+                              "append a 0 0 2\r\nyz\r\n",
+                              "set a 0 0 2\r\nabcdef\r\n",
+                              "set a 0 0 3\r\nab",
+                              "set a 0 0 99999999999999999999\r\n",
+                              "stats\r\n",
+                              "mg a v s t k f\r\n",
+                              "mg a q\r\n",
+                              "ms a 4 T0 F5\r\ndata\r\n",
+                              "ms a 2 MA\r\nzz\r\n",
+                              "ms a S4\r\n",
+                              "md a q\r\n",
+                              "mn\r\n",
+                              "bogus command\r\n",
+                              "get\r\n",
+                              "\r\n",
+                              "\n",
+                              "\r",
+                              " ",
+                              "  ",
+                              "noreply",
+                              "0",
+                              "4294967296",
+                              "a",
+                              "\t"};
+
+// Assembles random input out of pieces, then mutates some bytes
+std::string Generate(std::mt19937 &rnd) {
+    std::string input(2, '\0');
+    input[0] = char(rnd());
+    input[1] = char(rnd());
+
+    for (size_t count = 1 + rnd() % 24; count > 0; count--) {
+        switch (rnd() % 16) {
+        case 0:
+            // Long key
+            input.append(240 + rnd() % 20, 'k');
+            break;
+        case 1:
+            input.push_back(char(rnd()));
+            break;
+        default:
+            input.append(Pieces[rnd() % (sizeof(Pieces) / sizeof(Pieces[0]))]);
+        }
+    }
+
+    for (size_t flips = rnd() % 3; flips > 0; flips--) {
+        input[2 + rnd() % (input.size() - 2)] = char(rnd());
+    }
+    return input;
+}
+
+void Run(const std::string &input) {
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t runs = 10000;
+    uint32_t seed = std::random_device()();
+    bool replay = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = std::strtoull(argv[i] + 6, nullptr, 10);
+        } else if (std::strncmp(argv[i], "-seed=", 6) == 0) {
+            seed = std::strtoul(argv[i] + 6, nullptr, 10);
+        } else {
+            std::ifstream file(argv[i], std::ios::binary);
+            if (!file) {
+                std::cerr << "Error: can't open " << argv[i] << std::endl;
+                return 1;
+            }
+            Run(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+            replay = true;
+        }
+    }
+
+    if (!replay) {
+        std::cerr << "Fuzzer: " << runs << " runs, seed " << seed << std::endl;
+        std::mt19937 rnd(seed);
+        for (size_t i = 0; i < runs; i++) {
+            Run(Generate(rnd));
+        }
+    }
+    return 0;
+}
+#endif // AFINA_LIBFUZZER
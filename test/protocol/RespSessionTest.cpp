@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <protocol/RespSession.h>
+#include <storage/SimpleLRU.h>
+#include <storage/ThreadSafeSimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+// Runs input through the new session, returns everything it responded
+std::string Process(std::shared_ptr<Storage> storage, const std::string &input) {
+    Protocol::RespSession session(storage);
+    Execute::Output out;
+    EXPECT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    return out.str();
+}
+
+} // namespace
+
+TEST(RespSessionTest, SetGet) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("+OK\r\n$3\r\nbar\r\n$-1\r\n", Process(storage, "*3\r\n$3\r\nSET\r\n$3\r\nfoo\r\n$3\r\nbar\r\n"
+                                                              "*2\r\n$3\r\nget\r\n$3\r\nfoo\r\n"
+                                                              "*2\r\n$3\r\nGET\r\n$4\r\nnope\r\n"));
+}
+
+TEST(RespSessionTest, Inline) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("+PONG\r\n+OK\r\n$1\r\nv\r\n", Process(storage, "PING\r\nset k v\r\n\r\nget k\n"));
+}
+
+TEST(RespSessionTest, SetOptions) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("$-1\r\n+OK\r\n$-1\r\n+OK\r\n", Process(storage, "SET a 1 XX\r\nSET a 1 NX\r\nSET a 2 NX\r\n"
+                                                               "SET a 3 XX\r\n"));
+    ASSERT_EQ("-ERR syntax error\r\n", Process(storage, "SET a 1 NX XX\r\n"));
+
+    // Time to live isn't supported, value stays as it was
+    ASSERT_EQ("-ERR expire times are not supported\r\n-ERR expire times are not supported\r\n"
+              "-ERR invalid expire time in 'set' command\r\n$1\r\n3\r\n",
+              Process(storage, "SET a 4 EX 10\r\nSET a 5 PX 100\r\nSET a 6 EX 0\r\nGET a\r\n"));
+}
+
+TEST(RespSessionTest, MGetDel) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("a", "1");
+    storage->Put("c", "3");
+    ASSERT_EQ("*3\r\n$1\r\n1\r\n$-1\r\n$1\r\n3\r\n:2\r\n:0\r\n", Process(storage, "MGET a b c\r\nDEL a b c\r\nDEL a\r\n"));
+}
+
+TEST(RespSessionTest, Incr) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("s", "abc");
+    storage->Put("max", "9223372036854775807");
+    ASSERT_EQ(":1\r\n:2\r\n", Process(storage, "INCR n\r\nINCR n\r\n"));
+    ASSERT_EQ("-ERR value is not an integer or out of range\r\n", Process(storage, "INCR s\r\n"));
+    ASSERT_EQ("-ERR increment or decrement would overflow\r\n", Process(storage, "INCR max\r\n"));
+}
+
+// Clients of the different threads incrementing the same key don't lose increments
+TEST(RespSessionTest, ConcurrentIncr) {
+    std::shared_ptr<Storage> storage(new Backend::ThreadSafeSimplLRU());
+    std::vector<std::thread> clients;
+    for (int i = 0; i < 4; i++) {
+        clients.emplace_back([storage]() {
+            for (int j = 0; j < 1000; j++) {
+                Process(storage, "INCR n\r\n");
+            }
+        });
+    }
+    for (auto &client : clients) {
+        client.join();
+    }
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("n", value));
+    ASSERT_EQ("4000", value);
+}
+
+TEST(RespSessionTest, Expire) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("a", "1");
+    ASSERT_EQ("-ERR expire times are not supported\r\n$1\r\n1\r\n", Process(storage, "EXPIRE a 10\r\nGET a\r\n"));
+    ASSERT_EQ(":0\r\n:1\r\n$-1\r\n", Process(storage, "EXPIRE b 0\r\nEXPIRE a -1\r\nGET a\r\n"));
+}
+
+TEST(RespSessionTest, Errors) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("-ERR unknown command 'foo'\r\n-ERR wrong number of arguments for 'GET' command\r\n",
+              Process(storage, "foo\r\nGET\r\n"));
+    ASSERT_THROW(Process(storage, "*1\r\n+GET\r\n"), std::runtime_error);
+    ASSERT_THROW(Process(storage, "*1\r\n$3\r\nGETXX\r\n"), std::runtime_error);
+}
+
+// Bulk over the limit is refused and dropped as it arrives, next request is fine
+TEST(RespSessionTest, TooLarge) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    std::string big(2 * 1024 * 1024, 'x');
+    const std::string input = "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$" + std::to_string(big.size()) + "\r\n" + big +
+                              "\r\nGET k\r\n";
+    ASSERT_EQ("-ERR Protocol error: request is too large\r\n$-1\r\n", Process(storage, input));
+
+    // The same in chunks, refused bulk isn't kept
+    Protocol::RespSession session(storage);
+    Execute::Output out;
+    for (size_t pos = 0; pos < input.size(); pos += 4096) {
+        size_t len = std::min(size_t(4096), input.size() - pos);
+        ASSERT_EQ(len, session.Process(input.data() + pos, len, out));
+    }
+    ASSERT_EQ("-ERR Protocol error: request is too large\r\n$-1\r\n", out.str());
+
+    // Too many arguments break the connection
+    ASSERT_THROW(Process(storage, "*5000\r\n"), std::runtime_error);
+}
+
+// Requests splitted at any byte are assembled back
+TEST(RespSessionTest, Chunked) {
+    const std::string input = "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$10\r\n0123456789\r\nGET key\r\n";
+    for (size_t chunk = 1; chunk <= input.size(); chunk++) {
+        std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+        Protocol::RespSession session(storage);
+
+        Execute::Output out;
+        for (size_t pos = 0; pos < input.size(); pos += chunk) {
+            size_t len = std::min(chunk, input.size() - pos);
+            ASSERT_EQ(len, session.Process(input.data() + pos, len, out));
+        }
+        ASSERT_EQ("+OK\r\n$10\r\n0123456789\r\n", out.str());
+    }
+}
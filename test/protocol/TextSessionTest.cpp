@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <protocol/Session.h>
+#include <protocol/TextSession.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+
+namespace {
+
+// Runs input through the new session, returns everything it responded
+std::string Process(std::shared_ptr<Storage> storage, const std::string &input) {
+    Protocol::TextSession session(storage);
+    Execute::Output out;
+    EXPECT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    return out.str();
+}
+
+} // namespace
+
+TEST(TextSessionTest, SetGet) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("STORED\r\nVALUE foo 0 6\r\nfooval\r\nEND\r\n",
+              Process(storage, "set foo 0 0 6\r\nfooval\r\nget foo bar\r\n"));
+}
+
+TEST(TextSessionTest, Pipeline) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    Protocol::TextSession session(storage);
+
+    // Batch of commands executed in order, the last set waits for its value from the next read
+    Execute::Output out;
+    std::string input = "set a 0 0 1\r\n1\r\nset b 0 0 1\r\n2\r\nget a b\r\nset a 0 0 1\r\n";
+    ASSERT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    ASSERT_EQ("STORED\r\nSTORED\r\nVALUE a 0 1\r\n1\r\nVALUE b 0 1\r\n2\r\nEND\r\n", out.str());
+
+    out.clear();
+    input = "3\r\nget a\r\nget ";
+    ASSERT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    ASSERT_EQ("STORED\r\nVALUE a 0 1\r\n3\r\nEND\r\n", out.str());
+
+    out.clear();
+    input = "b\r\n";
+    ASSERT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    ASSERT_EQ("VALUE b 0 1\r\n2\r\nEND\r\n", out.str());
+}
+
+TEST(TextSessionTest, DirectBuffer) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    Protocol::TextSession session(storage);
+
+    // Nothing to read into directly until data block is announced
+    size_t size = 0;
+    ASSERT_EQ(nullptr, session.DirectBuffer(size));
+
+    Execute::Output out;
+    std::string input = "set foo 0 0 6\r\nfo";
+    ASSERT_EQ(input.size(), session.Process(input.data(), input.size(), out));
+    ASSERT_EQ("", out.str());
+
+    // Rest of the block and its terminator
+    char *place = session.DirectBuffer(size);
+    ASSERT_NE(nullptr, place);
+    ASSERT_EQ(6, size);
+    std::memcpy(place, "oval\r\n", size);
+    session.DirectFilled(size, out);
+    ASSERT_EQ("STORED\r\n", out.str());
+    ASSERT_EQ(nullptr, session.DirectBuffer(size));
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("foo", value));
+    ASSERT_EQ("fooval", value);
+}
+
+TEST(TextSessionTest, EmptyValue) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("STORED\r\nVALUE foo 0 0\r\n\r\nEND\r\n", Process(storage, "set foo 0 0 0\r\n\r\nget foo\r\n"));
+}
+
+TEST(TextSessionTest, BadDataTerminator) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    // Rest of the line after the block is dropped, next command is fine
+    ASSERT_EQ("CLIENT_ERROR bad data chunk\r\nSTORED\r\n",
+              Process(storage, "set foo 0 0 3\r\nbarXX and the rest\r\nset foo 0 0 3\r\nbaz\r\n"));
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("foo", value));
+    ASSERT_EQ("baz", value);
+}
+
+TEST(TextSessionTest, MetaGet) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("foo", "bar");
+
+    ASSERT_EQ("VA 3 s3 t-1 kfoo Oabc\r\nbar\r\n", Process(storage, "mg foo v s t k Oabc\r\n"));
+    ASSERT_EQ("HD f0 c0\r\n", Process(storage, "mg foo f c\r\n"));
+    ASSERT_EQ("EN\r\n", Process(storage, "mg nope v\r\n"));
+}
+
+TEST(TextSessionTest, MetaSetDelete) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+
+    ASSERT_EQ("HD kfoo\r\n", Process(storage, "ms foo 3 T0 F5 k\r\nbar\r\n"));
+    ASSERT_EQ("NS\r\n", Process(storage, "ms foo 1 ME\r\nx\r\n"));
+    ASSERT_EQ("NS\r\n", Process(storage, "ms nope 1 MR\r\nx\r\n"));
+    ASSERT_EQ("HD\r\n", Process(storage, "ms foo 2 MA\r\n!!\r\n"));
+    ASSERT_EQ("HD\r\n", Process(storage, "ms foo 2 MP\r\n<<\r\n"));
+
+    std::string value;
+    ASSERT_TRUE(storage->Get("foo", value));
+    ASSERT_EQ("<<bar!!", value);
+
+    ASSERT_EQ("HD\r\nNF\r\n", Process(storage, "md foo\r\nmd foo\r\n"));
+}
+
+// Quiet commands respond only on miss/failure, mn finishes the pipeline
+TEST(TextSessionTest, MetaQuietPipeline) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    storage->Put("a", "1");
+
+    ASSERT_EQ("VA 1 ka\r\n1\r\nMN\r\n", Process(storage, "ms b 1 q\r\n2\r\nmg a v k q\r\nmg c v k q\r\nmd b q\r\nmn\r\n"));
+
+    std::string value;
+    ASSERT_FALSE(storage->Get("b", value));
+}
+
+TEST(TextSessionTest, MetaChunked) {
+    const std::string input = "ms key 5 q\r\nvalue\r\nmg key v s\r\nmn\r\n";
+    for (size_t chunk = 1; chunk <= input.size(); chunk++) {
+        std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+        Protocol::TextSession session(storage);
+
+        Execute::Output out;
+        for (size_t pos = 0; pos < input.size(); pos += chunk) {
+            size_t len = std::min(chunk, input.size() - pos);
+            ASSERT_EQ(len, session.Process(input.data() + pos, len, out));
+        }
+        ASSERT_EQ("VA 5 s5\r\nvalue\r\nMN\r\n", out.str());
+    }
+}
+
+TEST(TextSessionTest, MetaErrors) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("CLIENT_ERROR bad command line format\r\n", Process(storage, "ms foo\r\n"));
+    ASSERT_EQ("CLIENT_ERROR bad meta flags\r\nMN\r\n", Process(storage, "ms foo 1 MX\r\nx\r\nmn\r\n"));
+    ASSERT_EQ("CLIENT_ERROR bad meta flags\r\n", Process(storage, "mg foo v Z\r\n"));
+}
+
+// Nothing is sent back on noreply, so nothing to write at all
+TEST(TextSessionTest, NoReply) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("", Process(storage, "set a 0 0 1 noreply\r\n1\r\nadd a 0 0 1 noreply\r\n2\r\n"
+                                   "append a 0 0 1 noreply\r\n3\r\n"));
+    ASSERT_EQ("VALUE a 0 2\r\n13\r\nEND\r\n", Process(storage, "get a\r\n"));
+
+    ASSERT_EQ("", Process(storage, "replace a 0 0 1 noreply\r\n4\r\nreplace b 0 0 1 noreply\r\n5\r\n"));
+    ASSERT_EQ("VALUE a 0 1\r\n4\r\nEND\r\n", Process(storage, "get a b\r\n"));
+}
+
+// Data block over the limit is dropped without being allocated, next command is fine
+TEST(TextSessionTest, TooLarge) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    std::string big(2 * 1024 * 1024, 'x');
+    ASSERT_EQ("CLIENT_ERROR object too large for cache\r\nMN\r\n",
+              Process(storage, "set b 0 0 " + std::to_string(big.size()) + "\r\n" + big + "\r\nmn\r\n"));
+
+    std::string value;
+    ASSERT_FALSE(storage->Get("b", value));
+}
+
+// Malformed commands are answered in their turn and don't affect their neighbours
+TEST(TextSessionTest, Malformed) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    ASSERT_EQ("STORED\r\nERROR\r\nCLIENT_ERROR key too long\r\nVALUE a 0 1\r\n1\r\nEND\r\n",
+              Process(storage, "set a 0 0 1\r\n1\r\nbogus command\r\nget " + std::string(300, 'k') +
+                                   " a\r\nget a\r\n"));
+}
+
+TEST(TextSessionTest, Reset) {
+    std::shared_ptr<Storage> storage(new Backend::SimpleLRU());
+    std::unique_ptr<Protocol::Session> session(new Protocol::TextSession(storage));
+    Protocol::Session *reused = session.get();
+
+    // Request cut in the middle of the value is dropped along with the connection it came from
+    Execute::Output out;
+    std::string input = "set a 0 0 5\r\nab";
+    ASSERT_EQ(input.size(), session->Process(input.data(), input.size(), out));
+
+    session = Protocol::Session::Detect('g', storage, std::move(session));
+    ASSERT_EQ(reused, session.get());
+
+    input = "get a\r\n";
+    ASSERT_EQ(input.size(), session->Process(input.data(), input.size(), out));
+    ASSERT_EQ("END\r\n", out.str());
+}
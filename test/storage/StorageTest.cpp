@@ -11,6 +11,7 @@
 #include <afina/execute/Set.h>
 
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina::Backend;
 using namespace Afina::Execute;
@@ -195,3 +196,37 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, Batch) {
+    ThreadSafeSimplLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+
+    // Operations inside of the batch must not take the lock batch already holds
+    std::string value;
+    storage.Batch([&value](Afina::Storage &batch) {
+        EXPECT_TRUE(batch.Put("KEY2", "val2"));
+        EXPECT_FALSE(batch.PutIfAbsent("KEY1", "other"));
+        EXPECT_TRUE(batch.Set("KEY1", "val3"));
+        EXPECT_TRUE(batch.Delete("KEY2"));
+        EXPECT_TRUE(batch.Get("KEY1", value));
+    });
+    EXPECT_TRUE(value == "val3");
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, GetShared) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+
+    // Value got before the update stays the same
+    std::shared_ptr<const std::string> value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY1", "val2"));
+    EXPECT_TRUE(*value == "val1");
+
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(*value == "val2");
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_TRUE(*value == "val2");
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}